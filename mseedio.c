@@ -0,0 +1,493 @@
+/*******************************************************************************
+ *                                 mseedio.c                                   *
+ *  miniSEED input functions:                                                  *
+ *      ismseed        Check if a file is in miniSEED format                   *
+ *      read_mseed     Read the data records of one channel as a SAC trace     *
+ *                                                                             *
+ *  Records are SEED 2.4 data records with blockette 1000, of any record       *
+ *  length and byte order. Samples encoded as 16 or 32 bit integers, 32 or 64  *
+ *  bit floats, Steim-1 or Steim-2 are supported.                              *
+ *                                                                             *
+ *  Reference:                                                                 *
+ *      SEED Reference Manual, Version 2.4, Chapter 8 (fixed section of data   *
+ *      header) and Appendix B (Steim compression), IRIS, 2012.                *
+ *                                                                             *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include "mseedio.h"
+
+#define MS_HEADER_SIZE  48      /* fixed section of data header */
+#define MS_FRAME_SIZE   64      /* Steim frame of 16 words */
+
+/* data encodings of blockette 1000 */
+#define MS_INT16    1
+#define MS_INT32    3
+#define MS_FLOAT32  4
+#define MS_FLOAT64  5
+#define MS_STEIM1   10
+#define MS_STEIM2   11
+
+/* a data record found in the file */
+typedef struct {
+    long    offset;         /* position of the record in the file */
+    int     reclen;         /* record length in bytes */
+    int     nsamp;          /* samples in the record */
+    int     encoding;       /* data encoding from blockette 1000 */
+    int     be;             /* TRUE if the data are big-endian */
+    int     data;           /* offset of the data in the record */
+    double  start;          /* time of the first sample in seconds since 1970 */
+    double  rate;           /* samples per second */
+    char    code[4][6];     /* network, station, location and channel codes */
+    int     first;          /* index of the first sample in the trace */
+    int     skip;           /* leading samples overlapping earlier records */
+} MSRECORD;
+
+/* function prototype for local use */
+static uint32_t ms_u32(const unsigned char *p, int be);
+static int      ms_u16(const unsigned char *p, int be);
+static int      ms_record(const unsigned char *p, long avail, MSRECORD *r);
+static int      ms_decode(const unsigned char *p, const MSRECORD *r, int32_t *x, float *ar);
+static int      decode_steim(const unsigned char *p, int nframe, int be, int level, int nsamp, int32_t *x);
+static void     ms_set_time(SACHEAD *hd, double t);
+static int      compare_start(const void *p1, const void *p2);
+
+/*
+ *  ismseed
+ *
+ *  Description: check if a file is in miniSEED format
+ *
+ *  In:
+ *      const char *name    :   file name
+ *  Return:
+ *      TRUE  : starts with a data record with blockette 1000
+ *      FALSE : not miniSEED, or unable to read
+ *
+ */
+int ismseed(const char *name)
+{
+    FILE    *strm;
+    unsigned char buf[256];
+    size_t  n;
+    MSRECORD r;
+
+    if ((strm = fopen(name, "rb")) == NULL) return FALSE;
+    n = fread(buf, 1, sizeof(buf), strm);
+    fclose(strm);
+    return (ms_record(buf, (long)n, &r) == 0) ? TRUE : FALSE;
+}
+
+/*
+ *  read_mseed
+ *
+ *  Description: read the data records of a miniSEED file as one evenly
+ *               sampled SAC trace. Only records of the channel of the first
+ *               record are read. Records are put in time order, samples
+ *               overlapping earlier records are dropped and gaps are
+ *               filled with zeros. Records are decoded in parallel if
+ *               OpenMP is available.
+ *
+ *  In:
+ *      const char *name    :   file name
+ *  Out:
+ *      SACHEAD    *hd      :   SAC header with delta, npts, b, e, the reference
+ *                              time at the first sample, depmin, depmax, depmen
+ *                              and the network, station, location and channel
+ *  Return:
+ *      float pointer to the data array, NULL if failed
+ *
+ */
+float *read_mseed(const char *name, SACHEAD *hd)
+{
+    FILE    *strm;
+    unsigned char *buf;
+    MSRECORD *rec, r;
+    long    size, pos;
+    int     i, n, nrec = 0, nother = 0, ngap = 0, nbad = 0, npts = 0;
+    float   *ar;
+    double  delta, mean = 0.0;
+
+    if ((strm = fopen(name, "rb")) == NULL) {
+        fprintf(stderr, "Unable to open %s\n", name);
+        return NULL;
+    }
+    if (fseek(strm, 0L, SEEK_END) || (size = ftell(strm)) < MS_HEADER_SIZE ||
+        fseek(strm, 0L, SEEK_SET)) {
+        fprintf(stderr, "Error in reading miniSEED file %s\n", name);
+        fclose(strm);
+        return NULL;
+    }
+    if ((buf = (unsigned char *)malloc((size_t)size)) == NULL ||
+        (rec = (MSRECORD *)malloc((size_t)(size / MS_HEADER_SIZE) * sizeof(MSRECORD))) == NULL) {
+        fprintf(stderr, "Error in allocating memory for reading %s\n", name);
+        free(buf);
+        fclose(strm);
+        return NULL;
+    }
+    if (fread(buf, (size_t)size, 1, strm) != 1) {
+        fprintf(stderr, "Error in reading miniSEED file %s\n", name);
+        free(buf); free(rec);
+        fclose(strm);
+        return NULL;
+    }
+    fclose(strm);
+
+    /* record headers */
+    for (pos = 0; pos + MS_HEADER_SIZE <= size; pos += r.reclen) {
+        if (ms_record(buf + pos, size - pos, &r) == -1 || r.reclen > size - pos) {
+            fprintf(stderr, "Warning: %s: no miniSEED data record at byte %ld, rest skipped.\n", name, pos);
+            break;
+        }
+        r.offset = pos;
+        if (r.nsamp == 0 || r.rate <= 0.0) continue;
+        if (nrec > 0 && memcmp(r.code, rec[0].code, sizeof(r.code))) {
+            nother++;
+            continue;
+        }
+        rec[nrec++] = r;
+    }
+    if (nrec == 0) {
+        fprintf(stderr, "Warning: %s: no miniSEED data records.\n", name);
+        free(buf); free(rec);
+        return NULL;
+    }
+    if (nother > 0)
+        fprintf(stderr, "Warning: %s: %d records of channels other than %s.%s.%s.%s skipped.\n",
+                name, nother, rec[0].code[0], rec[0].code[1], rec[0].code[2], rec[0].code[3]);
+
+    /* place the records on one time axis */
+    qsort(rec, (size_t)nrec, sizeof(MSRECORD), compare_start);
+    delta = 1.0 / rec[0].rate;
+    for (i = 0; i < nrec; i++) {
+        n = (int)floor((rec[i].start - rec[0].start) * rec[0].rate + 0.5);
+        if (n > npts) ngap++;
+        rec[i].skip  = (n < npts) ? npts - n : 0;
+        rec[i].first = n + rec[i].skip;
+        if (n + rec[i].nsamp > npts) npts = n + rec[i].nsamp;
+    }
+    if (ngap > 0)
+        fprintf(stderr, "Warning: %s: %d gaps filled with zeros.\n", name, ngap);
+
+    if ((ar = (float *)calloc((size_t)npts, sizeof(float))) == NULL) {
+        fprintf(stderr, "Error in allocating memory for reading %s\n", name);
+        free(buf); free(rec);
+        return NULL;
+    }
+
+    /* samples, one record at a time */
+#ifdef _OPENMP
+#pragma omp parallel for private(i) reduction(+:nbad) schedule(dynamic)
+#endif
+    for (i = 0; i < nrec; i++) {
+        int32_t *x;
+        if (rec[i].skip >= rec[i].nsamp) continue;
+        if ((x = (int32_t *)malloc(((size_t)rec[i].nsamp + 8) * sizeof(int32_t))) == NULL ||
+            ms_decode(buf + rec[i].offset, &rec[i], x, ar + rec[i].first - rec[i].skip))
+            nbad++;
+        free(x);
+    }
+    if (nbad > 0)
+        fprintf(stderr, "Warning: %s: %d records not decoded, filled with zeros.\n", name, nbad);
+
+    *hd = new_sac_head((float)delta, npts, 0.0);
+    ms_set_time(hd, rec[0].start);
+    hd->iztype = IB;
+    hd->depmin = hd->depmax = ar[0];
+    for (i = 0; i < npts; i++) {
+        if (ar[i] < hd->depmin) hd->depmin = ar[i];
+        if (ar[i] > hd->depmax) hd->depmax = ar[i];
+        mean += ar[i];
+    }
+    hd->depmen = (float)(mean / npts);
+    strcpy(hd->knetwk, rec[0].code[0]);
+    strcpy(hd->kstnm,  rec[0].code[1]);
+    strcpy(hd->khole,  rec[0].code[2]);
+    strcpy(hd->kcmpnm, rec[0].code[3]);
+
+    free(buf);
+    free(rec);
+    return ar;
+}
+
+/******************************************************************************
+ *                                                                            *
+ *              Functions below are only for local use!                       *
+ *                                                                            *
+ ******************************************************************************/
+
+/*
+ *  ms_u32, ms_u16
+ *
+ *  Description: unsigned integer in the given byte order
+ *
+ */
+static uint32_t ms_u32(const unsigned char *p, int be)
+{
+    return be ? (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]
+              : (uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 | (uint32_t)p[1] << 8 | p[0];
+}
+
+static int ms_u16(const unsigned char *p, int be)
+{
+    return be ? p[0] << 8 | p[1] : p[1] << 8 | p[0];
+}
+
+/*
+ *  ms_record
+ *
+ *  Description: parse the fixed header and blockettes 1000 and 1001 of a
+ *               data record. The byte order of the header is found from
+ *               the year and day of its start time.
+ *
+ *  In:
+ *      const unsigned char *p  :   start of the record
+ *      long            avail   :   bytes available from p
+ *  Out:
+ *      MSRECORD       *r       :   fields of the record, except offset, first and skip
+ *  Return:
+ *      0 if succeed, -1 if not a data record with blockette 1000, or if
+ *      its record length or data offset is out of range
+ *
+ */
+static int ms_record(const unsigned char *p, long avail, MSRECORD *r)
+{
+    int     be, i, k, year, day, nblk, blk, type, fact, mult, usec = 0;
+    static const int off[4] = {18, 8, 13, 15}, len[4] = {2, 5, 2, 3};
+    double  corr;
+
+    if (avail < MS_HEADER_SIZE || !strchr("DRQM", p[6]) || p[6] == '\0') return -1;
+    for (be = 1; be >= 0; be--) {
+        year = ms_u16(p + 20, be);
+        day  = ms_u16(p + 22, be);
+        if (year >= 1900 && year <= 2100 && day >= 1 && day <= 366) break;
+    }
+    if (be < 0) return -1;
+
+    memset(r, 0, sizeof(MSRECORD));
+    r->nsamp = ms_u16(p + 30, be);
+    fact = (int16_t)ms_u16(p + 32, be);
+    mult = (int16_t)ms_u16(p + 34, be);
+    if (fact > 0 && mult > 0)       r->rate = (double)fact * mult;
+    else if (fact > 0 && mult < 0)  r->rate = -(double)fact / mult;
+    else if (fact < 0 && mult > 0)  r->rate = -(double)mult / fact;
+    else if (fact < 0 && mult < 0)  r->rate = 1.0 / ((double)fact * mult);
+    nblk = p[39];
+    r->data = ms_u16(p + 44, be);
+    blk = ms_u16(p + 46, be);
+
+    /* blockettes 1000 and 1001 */
+    r->reclen = 0;
+    for (i = 0; i < nblk && blk >= MS_HEADER_SIZE && blk + 8 <= avail; i++) {
+        type = ms_u16(p + blk, be);
+        if (type == 1000) {
+            r->encoding = p[blk+4];
+            r->be = (p[blk+5] == 1);
+            if (p[blk+6] < 7 || p[blk+6] > 20) return -1;  /* records of 128 bytes to 1 MiB */
+            r->reclen = 1 << p[blk+6];
+        }
+        else if (type == 1001)
+            usec = (signed char)p[blk+5];
+        if (ms_u16(p + blk + 2, be) <= blk) break;
+        blk = ms_u16(p + blk + 2, be);
+    }
+    if (r->reclen < MS_HEADER_SIZE || r->data > r->reclen || (r->nsamp > 0 && r->data < MS_HEADER_SIZE)) return -1;
+
+    /* start time, with the time correction unless it is applied already */
+    corr = (p[36] & 0x02) ? 0.0 : (int32_t)ms_u32(p + 40, be) * 0.0001;
+    i = year - 1;
+    r->start = (365.0 * (year - 1970) + (i/4 - i/100 + i/400) - (1969/4 - 1969/100 + 1969/400) + day - 1) * 86400.0
+             + p[24] * 3600.0 + p[25] * 60.0 + p[26] + ms_u16(p + 28, be) * 0.0001 + usec * 1.0e-6 + corr;
+
+    /* network, station, location and channel codes without trailing blanks */
+    for (i = 0; i < 4; i++) {
+        memcpy(r->code[i], p + off[i], len[i]);
+        for (k = len[i]; k > 0 && r->code[i][k-1] == ' '; k--);
+        r->code[i][k] = '\0';
+    }
+    return 0;
+}
+
+/*
+ *  ms_decode
+ *
+ *  Description: decode the samples of a data record into ar, leaving out
+ *               the first r->skip samples
+ *
+ *  In:
+ *      const unsigned char *p  :   start of the record
+ *      const MSRECORD     *r   :   the record
+ *      int32_t            *x   :   work space of r->nsamp+8 integers
+ *  Out:
+ *      float              *ar  :   r->nsamp samples, of which the first r->skip are not written
+ *  Return:
+ *      0 if succeed, -1 if the encoding is not supported or the data are bad
+ *
+ */
+static int ms_decode(const unsigned char *p, const MSRECORD *r, int32_t *x, float *ar)
+{
+    const unsigned char *d = p + r->data;
+    int     i, n = r->nsamp, nbyte = r->reclen - r->data;
+    uint32_t u;
+    float   f;
+    union { uint64_t u; double f; } v;
+
+    switch (r->encoding) {
+        case MS_INT16:
+            if (2 * n > nbyte) return -1;
+            for (i = r->skip; i < n; i++) ar[i] = (int16_t)ms_u16(d + 2*i, r->be);
+            return 0;
+        case MS_INT32:
+            if (4 * n > nbyte) return -1;
+            for (i = r->skip; i < n; i++) ar[i] = (float)(int32_t)ms_u32(d + 4*i, r->be);
+            return 0;
+        case MS_FLOAT32:
+            if (4 * n > nbyte) return -1;
+            for (i = r->skip; i < n; i++) {
+                u = ms_u32(d + 4*i, r->be);
+                memcpy(&f, &u, sizeof(float));
+                ar[i] = f;
+            }
+            return 0;
+        case MS_FLOAT64:
+            if (8 * n > nbyte) return -1;
+            for (i = r->skip; i < n; i++) {
+                v.u = (uint64_t)ms_u32(d + 8*i + (r->be ? 0 : 4), r->be) << 32 | ms_u32(d + 8*i + (r->be ? 4 : 0), r->be);
+                ar[i] = (float)v.f;
+            }
+            return 0;
+        case MS_STEIM1:
+        case MS_STEIM2:
+            if (decode_steim(d, nbyte / MS_FRAME_SIZE, r->be, r->encoding - MS_STEIM1 + 1, n, x)) return -1;
+            for (i = r->skip; i < n; i++) ar[i] = (float)x[i];
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+/*
+ *  steim_unpack
+ *
+ *  Description: the n differences of bits each packed in the Steim word w,
+ *               sign extended. Called with constant n and bits, so that the
+ *               loop unrolls into straight shifts.
+ *
+ */
+static void steim_unpack(uint32_t w, int n, int bits, int32_t *d)
+{
+    int k;
+    for (k = 0; k < n; k++)
+        d[k] = (int32_t)(w << (32 - bits * (n - k))) >> (32 - bits);
+}
+
+/*
+ *  decode_steim
+ *
+ *  Description: decode Steim-1 or Steim-2 compressed samples in two passes.
+ *               All differences are unpacked first, without dependence
+ *               between words, then integrated from the forward integration
+ *               constant in one pass.
+ *
+ *  In:
+ *      const unsigned char *p  :   first frame
+ *      int         nframe      :   frames in the record
+ *      int         be          :   TRUE if the frames are big-endian
+ *      int         level       :   1 for Steim-1, 2 for Steim-2
+ *      int         nsamp       :   samples to decode
+ *  Out:
+ *      int32_t    *x           :   nsamp samples, with room for 8 more
+ *  Return:
+ *      0 if succeed, -1 if the frames are bad or the last sample differs
+ *      from the reverse integration constant
+ *
+ */
+static int decode_steim(const unsigned char *p, int nframe, int be, int level, int nsamp, int32_t *x)
+{
+    int     f, w, i, n = 0;
+    uint32_t ctrl, word;
+    int32_t x0 = 0, xn = 0;
+
+    for (f = 0; f < nframe && n < nsamp; f++, p += MS_FRAME_SIZE) {
+        ctrl = ms_u32(p, be);
+        for (w = 1; w < 16 && n < nsamp; w++) {
+            word = ms_u32(p + 4*w, be);
+            if (f == 0 && w == 1) { x0 = (int32_t)word; continue; }
+            if (f == 0 && w == 2) { xn = (int32_t)word; continue; }
+            switch ((ctrl >> (30 - 2*w)) & 3) {
+                case 0: break;
+                case 1: steim_unpack(word, 4, 8, x + n); n += 4; break;
+                case 2:
+                    if (level == 1) { steim_unpack(word, 2, 16, x + n); n += 2; break; }
+                    switch (word >> 30) {
+                        case 1: steim_unpack(word, 1, 30, x + n); n += 1; break;
+                        case 2: steim_unpack(word, 2, 15, x + n); n += 2; break;
+                        case 3: steim_unpack(word, 3, 10, x + n); n += 3; break;
+                        default: return -1;
+                    }
+                    break;
+                case 3:
+                    if (level == 1) { x[n++] = (int32_t)word; break; }
+                    switch (word >> 30) {
+                        case 0: steim_unpack(word, 5, 6, x + n); n += 5; break;
+                        case 1: steim_unpack(word, 6, 5, x + n); n += 6; break;
+                        case 2: steim_unpack(word, 7, 4, x + n); n += 7; break;
+                        default: return -1;
+                    }
+                    break;
+            }
+        }
+    }
+    if (n < nsamp) return -1;
+
+    /* the first difference refers to the previous record and is replaced by x0 */
+    x[0] = x0;
+    for (i = 1; i < nsamp; i++) x[i] += x[i-1];
+    return (x[nsamp-1] == xn) ? 0 : -1;
+}
+
+/*
+ *  ms_set_time
+ *
+ *  Description: set the reference time of hd to t seconds since 1970,
+ *               rounded down to the millisecond, and b to the remainder
+ *
+ */
+static void ms_set_time(SACHEAD *hd, double t)
+{
+    long long ms = (long long)floor(t * 1000.0 + 1.0e-4), day, rem;
+    int year = 1970, ylen;
+
+    day = (ms >= 0) ? ms / 86400000 : -((-ms + 86399999) / 86400000);
+    rem = ms - day * 86400000;
+    for (;;) {
+        ylen = (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) ? 366 : 365;
+        if (day < 0) {
+            year--;
+            day += (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) ? 366 : 365;
+        }
+        else if (day >= ylen) {
+            day -= ylen;
+            year++;
+        }
+        else break;
+    }
+    hd->nzyear = year;
+    hd->nzjday = (int)day + 1;
+    hd->nzhour = (int)(rem / 3600000);
+    hd->nzmin  = (int)(rem / 60000 % 60);
+    hd->nzsec  = (int)(rem / 1000 % 60);
+    hd->nzmsec = (int)(rem % 1000);
+    hd->b = (float)(floor((t - ms * 0.001) * 1.0e6 + 0.5) * 1.0e-6);    /* to the microsecond */
+    hd->e = hd->b + (hd->npts - 1) * hd->delta;
+}
+
+static int compare_start(const void *p1, const void *p2)
+{
+    const MSRECORD *r1 = (const MSRECORD *)p1, *r2 = (const MSRECORD *)p2;
+    if (r1->start != r2->start) return (r1->start < r2->start) ? -1 : 1;
+    return (r1->offset < r2->offset) ? -1 : (r1->offset > r2->offset);
+}
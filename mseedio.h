@@ -0,0 +1,17 @@
+/*******************************************************************************
+    Name:     mseedio.h
+
+    Purpose:  prototype for reading miniSEED (SEED 2.4 data records) into
+        the SAC header and data used by pssac
+
+*******************************************************************************/
+
+#ifndef _MSEEDIO_H
+#define _MSEEDIO_H
+
+#include "sacio.h"
+
+int ismseed(const char *name);
+float *read_mseed(const char *name, SACHEAD *hd);
+
+#endif /* mseedio.h */
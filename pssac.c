@@ -24,10 +24,56 @@
 #define THIS_MODULE_KEYS	"<DI,CCi,T-i,>XO,RG-"
 
 #include "gmt_dev.h"
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <sys/un.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/wait.h>
+#include <poll.h>
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <linux/fiemap.h>
+#endif
 #include "sacio.h"
+#include "mseedio.h"
+#include "pssac.h"
+#include "ttable.h"
 
 #define GMT_PROG_OPTIONS "->BJKOPRUVXYcht"
 
+#define PSSAC_N_FILTERS 32    /* maximum number of operations in -F */
+
+#define PSSAC_N_PLANS   16    /* maximum number of cached FFT lengths */
+
+#define PSSAC_CHUNK     256   /* traces or files read at a time by -I, -M, -T+c, -j, -y and read-ahead hints */
+
+#define PSSAC_RAW_MAX   ((size_t)1 << 31)  /* bytes of samples kept in memory by -j and -y */
+
+#define PSSAC_READAHEAD ((off_t)1 << 17)   /* files smaller than this are not worth a read-ahead hint */
+
+#define PSSAC_JOB_WAIT  10    /* seconds a -y client has to send its whole job */
+
+#define PSSAC_QBLOCK    256   /* samples sharing one offset and scale in -k+q cache files */
+#define PSSAC_N_WINDOWS 16    /* maximum number of -C windows */
+
+struct PSSAC_FILTER {   /* one data processing operation given by -F */
+    char type;          /* i|q|r|d|t|b|e|s|h|w|f */
+    unsigned int n_arg;
+    double arg[4];
+};
+
+struct PSSAC_FFT_PLAN { /* bit reversal and twiddle tables for one FFT length */
+    unsigned int n;     /* padded length, a power of 2 */
+    unsigned int *rev;  /* bit-reversed index of each sample */
+    double *wr, *wi;    /* cos and -sin of 2*pi*k/n, k < n/2 */
+};
+
 /* Control structure for pssac */
 
 struct PSSAC_CTRL {
@@ -36,9 +82,15 @@ struct PSSAC_CTRL {
         char **file;
         unsigned int n;
     } In;
-    struct PSSAC_C {    /* -C<t0>/<t1> */
+    struct PSSAC_A {    /* -Ar|t */
+        bool active;
+        char cmp;       /* 'R' or 'T' */
+    } A;
+    struct PSSAC_C {    /* -C<t0>/<t1>[+o<shift>], repeatable */
         bool active;
-        double t0, t1;
+        int n;              /* number of windows */
+        double t0[PSSAC_N_WINDOWS], t1[PSSAC_N_WINDOWS];
+        double shift[PSSAC_N_WINDOWS];  /* +o: offset of the window along the time axis */
     } C;
 	struct PSSAC_D {	/* -D<dx>/<dy> */
 		bool active;
@@ -48,9 +100,14 @@ struct PSSAC_CTRL {
         bool active;
         char keys[GMT_LEN256];
     } E;
-    struct PSSAC_F {    /* -Fiqr */
+    struct PSSAC_F {    /* -F<op1><op2>... */
         bool active;
         char keys[GMT_LEN256];
+        unsigned int n_ops;
+        struct PSSAC_FILTER op[PSSAC_N_FILTERS];
+        bool spectral;      /* true if any of h|w|f is used */
+        unsigned int n_plans;
+        struct PSSAC_FFT_PLAN plan[PSSAC_N_PLANS];
     } F;
     struct PSSAC_G {    /* -G[p|n]+g<fill>+z<zero>+t<t0>/<t1> */
         bool active[2];
@@ -60,25 +117,80 @@ struct PSSAC_CTRL {
         float t0[2];
         float t1[2];
     } G;
-    struct PSSAC_M {    /* -M<size>/<alpha> */
+    struct PSSAC_M {    /* -M<size>/<alpha>|g|m|p<pct> */
         bool active;
         double size;
         bool norm;      /* true if -M<size> */
         bool scaleALL;  /* true if alpha=0 */
         double alpha;
         bool dist_scaling; /* true if alpha>=0 */
+        unsigned int global;  /* PSSAC_GLOBAL_MAX|MEDIAN|PERCENTILE if -M<size>/g|m|p */
+        double percent;       /* percentile for -M<size>/p<pct> */
     } M;
-    struct PSSAC_T {   /* -T+t<n>+r<reduce_vel>+s<shift> */
+    struct PSSAC_T {   /* -T+t<n>+p<phase>+r<reduce_vel>+s<shift>+c<t0>/<t1>[/<ref>|s<niter>] */
         bool active;
         bool align;
         int tmark;
         bool reduce;
         double reduce_vel;
         double shift;
+        char phase;         /* +p: align on predicted P or S arrival */
+        bool xcorr;         /* +c: align by cross-correlation */
+        double xc_t0, xc_t1;
+        int xc_ref;         /* index of the reference trace */
+        int xc_niter;       /* >0 if the reference is an iterative stack */
     } T;
+    struct PSSAC_H {    /* -H */
+        bool active;
+    } H;
+    struct PSSAC_S {    /* -S */
+        bool active;
+    } S;
+    struct PSSAC_N {    /* -N<bin>[+n<root>|+p<power>] */
+        bool active;
+        double bin;         /* bin width in units of the -E coordinate */
+        char mode;          /* l: linear, n: nth-root, p: phase-weighted stack */
+        double order;       /* root for +n, power for +p */
+    } N;
+    struct PSSAC_Q {    /* -Q[<fifo>] */
+        bool active;
+        char file[GMT_LEN256];  /* stream to read, stdin if empty */
+    } Q;
+    struct PSSAC_Z {    /* -Z[b] */
+        bool active;
+        bool build;     /* build missing or stale pyramids first */
+    } Z;
+    struct PSSAC_L {    /* -L<row_length> */
+        bool active;
+        double length;  /* seconds per helicorder row */
+    } L;
 	struct PSSAC_W {	/* -W<pen> */
 		struct GMT_PEN pen;
 	} W;
+    struct PSSAC_I {    /* -I[<dpi>] */
+        bool active;
+        double dpi;
+    } I;
+    struct PSSAC_e {    /* -e<stations>[+e<evla>/<evlo>[/<evdp>]] */
+        bool active;
+        char file[GMT_LEN256];
+    } e;
+    struct PSSAC_j {    /* -j<jobfile>[+n<nproc>] */
+        bool active;
+        char file[GMT_LEN256];
+        int nproc;      /* jobs running at the same time */
+    } j;
+    struct PSSAC_k {    /* -k<dir>[+p][+q] */
+        bool active;
+        char dir[GMT_LEN256];
+        bool plot;          /* +p: also cache the plotted coordinates */
+        bool quant;         /* +q: cache traces as 16-bit samples with a scale per block */
+        uint64_t opt_hash;  /* +p: hash of the options that change plotted coordinates */
+    } k;
+    struct PSSAC_l {    /* -l<statefile> */
+        bool active;
+        char file[GMT_LEN256];
+    } l;
     struct PSSAC_m {
         bool active;
         double sec_per_measure;
@@ -86,15 +198,119 @@ struct PSSAC_CTRL {
     struct PSSAC_v {
         bool active;
     } v;
+    struct PSSAC_y {    /* -y<socket> */
+        bool active;
+        char socket[GMT_LEN256];
+    } y;
+};
+
+enum PSSAC_global {    /* global normalization modes for -M<size>/g|m|p */
+    PSSAC_GLOBAL_NONE = 0,
+    PSSAC_GLOBAL_MAX,
+    PSSAC_GLOBAL_MEDIAN,
+    PSSAC_GLOBAL_PERCENTILE
 };
 
 struct SAC_LIST {
     char *file;
+    char *file2;    /* second horizontal component to rotate with file by -A */
     bool position;
     double x;
     double y;
     bool custom_pen;
     struct GMT_PEN pen;
+    /* filled by load_sac_trace */
+    bool loaded;    /* true if hd and data are already in memory */
+    SACHEAD hd;     /* SAC header, depmin/depmax/depmen updated after -F */
+    double *data;   /* samples after -F preprocessing */
+    double tref;    /* reference time determined by -T */
+    bool bad;       /* true if the trace could not be loaded */
+    bool has_geom;  /* true if geom was computed from coordinates */
+    float geom[4];  /* gcarc, az, baz and dist computed by complete_geometry */
+    bool fixed_tref;    /* tref set by stitch_segments or -T+c instead of -T */
+    int trace;      /* -S: index of the stitched trace this segment belongs to */
+    double amp;     /* -S: depmax-depmin of the whole stitched trace */
+    bool resumed;       /* -l: continue from the last run */
+    int first_sample;   /* -l: first sample to read */
+    int npts_done;      /* -l: samples consumed up to this run */
+    double yscale;      /* -l: scale factor used for this trace */
+    int win;            /* -C: index of the window of this entry */
+    bool prefetched;    /* -C: hd and data read with the first window of the file, not processed yet */
+};
+
+struct PSSAC_PLOT {     /* -k+p: coordinates of one plotted trace */
+    int n;              /* points after scaling and shifting */
+    int npts;           /* points after projection */
+    double x0, y0, yscale;
+    double *x, *y;      /* scaled and shifted */
+    double *xp, *yp;    /* projected */
+    unsigned int *pen;
+};
+
+struct PSSAC_RASTER {   /* -I: density of lines and fills at device resolution */
+    int nx, ny;
+    unsigned int *line;     /* line hits per pixel */
+    unsigned int *fill[2];  /* positive and negative fill coverage per pixel */
+};
+
+struct PSSAC_RAW {      /* -j/-y: a SAC file kept in memory across plot jobs */
+    char *file;
+    bool borrowed;      /* registered by pssac_register_trace; data belongs to the caller */
+    time_t mtime;       /* file modification time and size when read */
+    off_t size;
+    SACHEAD hd;
+    float *data;        /* all samples as stored in the file */
+    bool mseed;         /* decoded from miniSEED; coordinates come from -e */
+    bool pinned;        /* needed by the jobs being warmed up; never dropped for space */
+};
+
+/* process-level cache of raw SAC files, filled by -j and -y and inherited by their jobs,
+ * and of the traces registered by pssac_register_trace */
+static struct PSSAC_RAW *raw_cache = NULL;
+static int n_raw = 0, n_raw_alloc = 0;
+static size_t raw_bytes = 0;
+static int *raw_index = NULL;   /* raw_cache entries by FNV-1a hash of the file name, -1 if empty */
+static int n_raw_index = 0;     /* size of raw_index, a power of 2 at least twice n_raw_alloc */
+static bool in_job = false;     /* this process runs a plot job of -j or -y */
+
+struct PSSAC_BUNDLE {   /* a SAC bundle whose traces are in the raw cache as <file>#<member> */
+    char *file;
+    time_t mtime;       /* file modification time and size when read */
+    off_t size;
+    SACBUNDLE bd;
+};
+
+static struct PSSAC_BUNDLE *bundles = NULL;
+static int n_bundles = 0;
+
+struct PSSAC_PLACE {    /* where a file lies on disk, to read files in the order of least seeking */
+    dev_t dev;
+    uint64_t extent;    /* physical offset of the first extent, 0 if unknown */
+    ino_t ino;
+    int n;              /* index of the file or SAC list entry */
+};
+
+struct PSSAC_STATION {  /* -e: coordinates of a station of miniSEED data */
+    char net[9];
+    char sta[9];
+    float lat, lon, elev;
+};
+
+static struct PSSAC_STATION *stations = NULL;
+static int n_stations = 0;
+static float mseed_event[3] = {SAC_FLOAT_UNDEF, SAC_FLOAT_UNDEF, SAC_FLOAT_UNDEF};   /* -e+e: evla, evlo, evdp */
+
+struct PSSAC_SEGMENT {  /* -S: sort key of one SAC file */
+    char key[4*9];  /* knetwk.kstnm.khole.kcmpnm */
+    double start;   /* absolute begin time */
+    int n;          /* index in the SAC list */
+};
+
+struct PSSAC_JOIN {     /* -S: end of the previous segment, carried into the next one */
+    int trace;          /* stitched trace of the previous segment, -1 for none */
+    double end;         /* time of its last sample relative to tref */
+    double last;        /* its last sample after -F */
+    double z[PSSAC_N_FILTERS][2*(2*PSSAC_N_FILTERS+2)];    /* state of the -Fb sections */
 };
 
 
@@ -110,8 +326,14 @@ void *New_pssac_Ctrl (struct GMT_CTRL *GMT) {	/* Allocate and initialize a new c
 }
 
 void Free_pssac_Ctrl (struct GMT_CTRL *GMT, struct PSSAC_CTRL *C) {	/* Deallocate control structure */
+	unsigned int k;
 	if (!C) return;
 	GMT_freepen (GMT, &C->W.pen);
+	for (k = 0; k < C->F.n_plans; k++) {
+		GMT_free (GMT, C->F.plan[k].rev);
+		GMT_free (GMT, C->F.plan[k].wr);
+		GMT_free (GMT, C->F.plan[k].wi);
+	}
 	GMT_free (GMT, C);
 }
 
@@ -122,10 +344,10 @@ int GMT_pssac_usage (struct GMTAPI_CTRL *API, int level)
 	GMT_show_name_and_purpose (API, THIS_MODULE_LIB, THIS_MODULE_NAME, THIS_MODULE_PURPOSE);
 	if (level == GMT_MODULE_PURPOSE) return (GMT_NOERROR);
 	GMT_Message (API, GMT_TIME_NONE, "usage: pssac <saclist>|<sacfiles> %s %s\n", GMT_J_OPT, GMT_Rgeoz_OPT);
-    GMT_Message (API, GMT_TIME_NONE, "\t[%s] [-C[<t0>/<t1>]] [-D<dx>[/<dy>]] [-Ea|b|k|d|n[<n>]|u[<n>]] [-F[i][q][r]]\n", GMT_B_OPT);
-    GMT_Message (API, GMT_TIME_NONE, "\t[-G[p|n][+g<fill>][+t<t0>/<t1>][+z<zero>]] [-K] [-M<size>/<alpha>] [-O] [-P]\n");
-    GMT_Message (API, GMT_TIME_NONE, "\t[-T[+t<tmark>][+r<reduce_vel>][+s<shift>]] [%s] [%s] \n", GMT_U_OPT, GMT_V_OPT);
-    GMT_Message (API, GMT_TIME_NONE, "\t[-W<pen>] [%s] [%s] [%s] \n\t[%s] [%s] [-m<sec_per_measure>] [-v]\n", GMT_X_OPT, GMT_Y_OPT, GMT_c_OPT, GMT_h_OPT, GMT_t_OPT);
+    GMT_Message (API, GMT_TIME_NONE, "\t[-Ar|t] [%s] [-C[<t0>/<t1>][+o<shift>]] [-D<dx>[/<dy>]] [-Ea|b|k|d|n[<n>]|u[<n>]] [-F<ops>]\n", GMT_B_OPT);
+    GMT_Message (API, GMT_TIME_NONE, "\t[-G[p|n][+g<fill>][+t<t0>/<t1>][+z<zero>]] [-H] [-I[<dpi>]] [-K] [-L<row_length>] [-M<size>[/<alpha>|g|m|p<pct>]]\n\t[-N<bin>[+n<root>|+p<power>]] [-O] [-P] [-Q[<fifo>]] [-S]\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t[-T[+t<tmark>][+p<phase>][+r<reduce_vel>][+s<shift>][+c<t0>/<t1>[/<ref>|s<niter>]]] [%s] [%s] \n", GMT_U_OPT, GMT_V_OPT);
+    GMT_Message (API, GMT_TIME_NONE, "\t[-W<pen>] [%s] [%s] [-Z[b]] [%s] \n\t[-e<stations>[+e<evla>/<evlo>[/<evdp>]]] [%s] [%s] [-j<jobfile>[+n<nproc>]] [-k<dir>[+p][+q]]\n\t[-l<statefile>] [-m<sec_per_measure>] [-v] [-y<socket>]\n", GMT_X_OPT, GMT_Y_OPT, GMT_c_OPT, GMT_h_OPT, GMT_t_OPT);
     GMT_Message (API, GMT_TIME_NONE, "\n");
 
     if (level == GMT_SYNOPSIS) return (EXIT_FAILURE);
@@ -140,11 +362,18 @@ int GMT_pssac_usage (struct GMTAPI_CTRL *API, int level)
     GMT_Message (API, GMT_TIME_NONE, "\t      On geographic plots, the default <X> and <Y> are determinted by stlo and stla from SAC header.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t      The <X> and <Y> given here will override the position determined by command line options.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   If <pen> is given, it will override the pen from -W option for current SAC file only.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   With -A, <filename> may be a pair of horizontal components <file1>,<file2>.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   A SAC bundle written by sacbundle stands for all its traces, <bundle>#<name> for one of them.\n");
     GMT_Option (API, "J-Z,R");
     GMT_Message (API, GMT_TIME_NONE, "\n\tOPTIONS:\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t-A Rotate pairs of horizontal components to radial (r) or transverse (t) using baz and cmpaz.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   Pairs are given as <file1>,<file2> or matched by knetwk, kstnm, khole and kcmpnm.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   Only the requested component is plotted.\n");
     GMT_Option (API, "B-");
     GMT_Message (API, GMT_TIME_NONE, "\t-C Only read and plot data between t0 and t1. The reference time of t0 and t1 is determined by -T option\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   Default to read and plot the whole trace. If only -C is used, t0 and t1 are determined from -R option\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   Repeat -C to plot several windows of each file, read with one open. Append +o<shift> to move\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   the window by <shift> seconds along the time axis.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t-D Offset all traces by <dx>/<dy>. PROJ_LENGTH_UNIT is used if unit is not specified.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t-E Determine profile type (Y axis). \n");
     GMT_Message (API, GMT_TIME_NONE, "\t   a: azimuth profile\n");
@@ -157,15 +386,31 @@ int GMT_pssac_usage (struct GMTAPI_CTRL *API, int level)
     GMT_Message (API, GMT_TIME_NONE, "\t   i: integral\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   q: square\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   r: remove mean value\n");
-    GMT_Message (API, GMT_TIME_NONE, "\t   i|q|r can repeat mutiple times. -Frii will convert accerate to displacement.\n");
-    GMT_Message (API, GMT_TIME_NONE, "\t   The order of i|q|r controls the order of the data processing.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   d: remove linear trend\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   t[<width>]: cosine taper <width> (fraction of the trace, default 0.05) at both ends\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   b<f1>/<f2>[/<order>[/<passes>]]: Butterworth bandpass between <f1> and <f2> Hz.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t      <f1>=0 gives a lowpass, <f2>=0 a highpass. Default <order> is 2 and <passes> is 1 (2 for zero phase).\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   e<win>: envelope, smoothing absolute amplitude with a running mean of <win> seconds\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   s<factor>: decimate by integer <factor> after an anti-alias lowpass\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   h: envelope from the Hilbert transform\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   w[<width>]: spectral whitening, amplitude spectrum smoothed over <width> Hz [Default flattens it]\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   f<f1>/<f2>/<f3>/<f4>: frequency-domain bandpass, cosine tapered from <f1> to <f2> and from <f3> to <f4> Hz\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   h|w|f use FFTs whose tables are shared by all traces of the same length.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   All operations can repeat mutiple times. -Frii will convert accerate to displacement.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   The order of operations controls the order of the data processing, e.g. -Frdt0.1b0.02/0.2/4s5\n");
     GMT_Message (API, GMT_TIME_NONE, "\t-G Paint postive or negative portion of traces.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   If only -G is used, default to fill the positive portion black.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   [p|n] controls the painting of postive portion or negative portion. Repeat -G option to specify fills for pos/neg portion, respectively.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   +g<fill>: color to fill\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   +t<t0>/<t1>: paint traces between t0 and t1 only. The reference time of t0 and t1 is determined by -T option.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   +z<zero>: define zero line. From <zero> to top is positive portion, from <zero> to bottom is negative portion.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t-H Write dist, az, baz and gcarc computed from stla, stlo, evla and evlo back to\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   SAC files where they are not defined. Only the header is rewritten, in place.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t-I Plot the density of all traces as one image of <dpi> [300] pixels per inch, instead of lines.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   Pixels are shaded from white to the pen color (and fill colors of -G) by the number of traces covering them.\n");
     GMT_Option (API, "K");
+    GMT_Message (API, GMT_TIME_NONE, "\t-L Helicorder. Wrap traces into rows of <row_length> seconds. Row r covers times\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   from r*<row_length> to (r+1)*<row_length> relative to the reference time, and is plotted at y=r.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t-M Vertical scaling\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   <size>: each trace will scaled to <size>[u]. The default unit is PROJ_LENGTH_UNIT.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t      The scale factor is defined as yscale = size*(north-south)/(depmax-depmin)/map_height \n");
@@ -173,22 +418,157 @@ int GMT_pssac_usage (struct GMTAPI_CTRL *API, int level)
     GMT_Message (API, GMT_TIME_NONE, "\t      <alpha> < 0, use the same scale factor for all trace. The scale factor scale the first trace to <size>[u]\n");
     GMT_Message (API, GMT_TIME_NONE, "\t      <alpha> = 0, yscale=size, no unit is allowed. \n");
     GMT_Message (API, GMT_TIME_NONE, "\t      <alpha> > 0, yscale=size*r^alpha, r is the distance range in km.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   <size>/g|m|p<pct>: use the same scale factor for all traces, which scales\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t      the global maximum (g), the median (m) or the <pct> percentile (p) of (depmax-depmin) of all traces to <size>[u].\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t-N Stack traces in bins of <bin> along the -E coordinate (a, b, d, k or u) and plot one trace per bin.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   The stack is linear by default. Append +n<root> for an nth-root stack, or\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   +p<power> for a phase-weighted stack with the phase coherence raised to <power> [2].\n");
     GMT_Option (API, "O,P");
+    GMT_Message (API, GMT_TIME_NONE, "\t-Q Read a stream of concatenated binary SAC files from <fifo> [stdin], after any other files,\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   and plot each trace as it arrives.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t-S Stitch segments of continuous data. SAC files of the same knetwk, kstnm, khole and kcmpnm\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   are plotted as one trace in order of absolute begin time. Lines break at gaps and overlaps are trimmed.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t-T Time alignment. \n");
     GMT_Message (API, GMT_TIME_NONE, "\t   +t<tmark> align all trace along time mark. Choose <tmark> from -5(b), -3(o), -2(a), 0-9(t0-t9).\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   +p<phase> align all traces along the predicted arrival of the first P or S in IASP91,\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t      computed from o, gcarc and evdp in SAC header with built-in travel time tables.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   +r<reduce_vel> reduce velocity in km/s.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   +s<shift> shift all traces by <shift> seconds.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   +c<t0>/<t1>[/<ref>|s<niter>] further align traces by cross-correlation in the window <t0>/<t1>\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t      against trace number <ref> [0] or an iterative stack of all traces (s, <niter> iterations [2]).\n");
     GMT_Option (API, "U,V");
     GMT_pen_syntax (API->GMT, 'W', "Set pen attributes [Default pen is %s]:", 0);
-    GMT_Option (API, "X,c,h,t");
+    GMT_Option (API, "X");
+    GMT_Message (API, GMT_TIME_NONE, "\t-Z Plot from min/max pyramid sidecars <sacfile>.pyr when they resolve the plot, instead of all samples.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   Append b to build missing or outdated sidecars first.\n");
+    GMT_Option (API, "c");
+    GMT_Message (API, GMT_TIME_NONE, "\t-e Read station coordinates of miniSEED data from the table <stations>, with records\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   <net> <sta> <lat> <lon> [<elev>]. Append +e<evla>/<evlo>[/<evdp>] to set the event location.\n");
+    GMT_Option (API, "h,t");
+    GMT_Message (API, GMT_TIME_NONE, "\t-j Run the plot jobs in <jobfile>, one per line: the output PostScript file, then pssac options and files.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   All SAC files are read once and shared by the jobs, which run <nproc> at a time [number of CPUs].\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t-k Cache decoded and -F processed traces in directory <dir>, e.g. on /dev/shm, so that\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   later pssac calls on the same files and with the same -A, -C and -F read them from there.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   Append +p to also cache the plotted coordinates of each trace, so that traces whose file and\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   options did not change are drawn without reading and processing them again.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   Append +q to cache traces as 16-bit samples with an offset and scale per block of %d samples.\n", PSSAC_QBLOCK);
+    GMT_Message (API, GMT_TIME_NONE, "\t-l Live mode for growing SAC files. Only samples appended since the last run are read\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   and plotted, with the scale factor of the last run. The state is kept in <statefile>.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t-m Time scaling while plotting on geographic plots.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t   <sec_per_measure> is in second per inch.\n");
     GMT_Message (API, GMT_TIME_NONE, "\t-v Plot traces vertically.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t-y Run as a server of plot jobs on the Unix domain socket <socket>, keeping SAC files in memory\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   between jobs. A job is one line of pssac options and files, optionally followed by a saclist.\n");
+    GMT_Message (API, GMT_TIME_NONE, "\t   Its PostScript is written back to the socket. The job \"quit\" stops the server.\n");
     GMT_Option (API, ".");
 
 	return (EXIT_FAILURE);
 }
 
+uint64_t fnv1a (uint64_t hash, const char *s)
+{
+    /* continue the 64-bit FNV-1a hash of a string */
+    for (; *s; s++) {
+        hash ^= (unsigned char)*s;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+double filter_number (char *c, char **end)
+{
+    /* [+|-]<digits>[.<digits>] at c, without the exponent strtod would read, since e is an operation */
+    char *p = c, save;
+    double x;
+
+    if (*p == '+' || *p == '-') p++;
+    while (isdigit ((unsigned char)*p)) p++;
+    if (*p == '.') p++;
+    while (isdigit ((unsigned char)*p)) p++;
+    save = *p;
+    *p = '\0';
+    x = strtod (c, end);
+    *p = save;
+    return x;
+}
+
+unsigned int parse_filters (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, char *arg)
+{
+    /* Parse the -F chain, e.g. -Frdt0.05b0.1/2/4/2 */
+    unsigned int n_errors = 0;
+    char *c = arg, *end = NULL;
+    struct PSSAC_FILTER *F = NULL;
+
+    while (*c) {
+        if (Ctrl->F.n_ops == PSSAC_N_FILTERS) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Syntax error -F option: too many operations (max %d)\n", PSSAC_N_FILTERS);
+            return (n_errors + 1);
+        }
+        F = &Ctrl->F.op[Ctrl->F.n_ops++];
+        F->type = *c++;
+        F->n_arg = 0;
+        if (strchr ("hwf", F->type)) Ctrl->F.spectral = true;
+        if (strchr ("iqrdh", F->type)) continue;    /* operations without arguments */
+        if (!strchr ("tbeswf", F->type)) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Syntax error -F option: unknown operation %c\n", F->type);
+            n_errors++;
+            continue;
+        }
+        /* collect <arg1>[/<arg2>...] */
+        do {
+            if (*c == '/') c++;
+            F->arg[F->n_arg] = filter_number (c, &end);
+            if (end == c) break;
+            c = end;
+            F->n_arg++;
+        } while (*c == '/' && F->n_arg < 4);
+
+        switch (F->type) {
+            case 't':
+                if (F->n_arg == 0) F->arg[F->n_arg++] = 0.05;
+                if (F->arg[0] <= 0.0 || F->arg[0] > 0.5) {
+                    GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Syntax error -Ft<width>: <width> must be in (0, 0.5]\n");
+                    n_errors++;
+                }
+                break;
+            case 'b':
+                if (F->n_arg < 2 || F->arg[0] < 0.0 || F->arg[1] < 0.0 || (F->arg[1] > 0.0 && F->arg[0] >= F->arg[1])) {
+                    GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Syntax error -Fb<f1>/<f2>[/<order>[/<passes>]]: need 0 <= f1 < f2\n");
+                    n_errors++;
+                }
+                if (F->n_arg < 3) F->arg[2] = 2;
+                if (F->n_arg < 4) F->arg[3] = 1;
+                if (F->arg[2] < 1 || F->arg[2] > 2*PSSAC_N_FILTERS || (F->arg[3] != 1 && F->arg[3] != 2)) {
+                    GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Syntax error -Fb: <order> must be 1-%d and <passes> 1 or 2\n", 2*PSSAC_N_FILTERS);
+                    n_errors++;
+                }
+                break;
+            case 'e':
+                if (F->n_arg != 1 || F->arg[0] < 0.0) {
+                    GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Syntax error -Fe<win>: give window length in seconds\n");
+                    n_errors++;
+                }
+                break;
+            case 'w':
+                if (F->n_arg == 0) F->arg[F->n_arg++] = 0.0;
+                break;
+            case 'f':
+                if (F->n_arg != 4 || F->arg[0] < 0.0 || F->arg[0] > F->arg[1] || F->arg[1] > F->arg[2] || F->arg[2] > F->arg[3]) {
+                    GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Syntax error -Ff<f1>/<f2>/<f3>/<f4>: need 0 <= f1 <= f2 <= f3 <= f4\n");
+                    n_errors++;
+                }
+                break;
+            case 's':
+                if (F->n_arg != 1 || F->arg[0] < 1.0 || F->arg[0] != floor (F->arg[0])) {
+                    GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Syntax error -Fs<factor>: <factor> must be a positive integer\n");
+                    n_errors++;
+                }
+                break;
+        }
+    }
+    return (n_errors);
+}
+
 int GMT_pssac_parse (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct GMT_OPTION *options)
 {
 	/* This parses the options provided to pssac and sets parameters in Ctrl.
@@ -200,6 +580,7 @@ int GMT_pssac_parse (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct GMT_O
 
 	unsigned int n_errors = 0;
 	char txt_a[GMT_LEN256] = {""}, txt_b[GMT_LEN256] = {""};
+    char *c = NULL;
 	struct GMT_OPTION *opt = NULL;
 	struct GMTAPI_CTRL *API = GMT->parent;
 
@@ -222,11 +603,30 @@ int GMT_pssac_parse (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct GMT_O
 
 			/* Processes program-specific parameters */
 
+            case 'A':
+                Ctrl->A.active = true;
+                switch (opt->arg[0]) {
+                    case 'r': case 'R': Ctrl->A.cmp = 'R'; break;
+                    case 't': case 'T': Ctrl->A.cmp = 'T'; break;
+                    default:
+                        GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -A option: -Ar|t\n");
+                        n_errors++;
+                        break;
+                }
+                break;
+
             case 'C':
                 Ctrl->C.active = true;
-                if ((j = sscanf (opt->arg, "%lf/%lf", &Ctrl->C.t0, &Ctrl->C.t1)) != 2) {
-                    Ctrl->C.t0 = GMT->common.R.wesn[XLO];
-                    Ctrl->C.t1 = GMT->common.R.wesn[XHI];
+                if (Ctrl->C.n == PSSAC_N_WINDOWS) {
+                    GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -C option: At most %d windows\n", PSSAC_N_WINDOWS);
+                    n_errors++;
+                    break;
+                }
+                k = Ctrl->C.n++;
+                if ((c = strstr (opt->arg, "+o")) != NULL) Ctrl->C.shift[k] = atof (c+2);
+                if ((j = sscanf (opt->arg, "%lf/%lf", &Ctrl->C.t0[k], &Ctrl->C.t1[k])) != 2) {
+                    Ctrl->C.t0[k] = GMT->common.R.wesn[XLO];
+                    Ctrl->C.t1[k] = GMT->common.R.wesn[XHI];
                 }
                 break;
 
@@ -249,6 +649,7 @@ int GMT_pssac_parse (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct GMT_O
             case 'F':
                 Ctrl->F.active = true;
                 strcpy(Ctrl->F.keys, &opt->arg[0]);
+                n_errors += parse_filters (GMT, Ctrl, opt->arg);
                 break;
 
             case 'G':      /* phase painting */
@@ -284,6 +685,52 @@ int GMT_pssac_parse (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct GMT_O
                 }
                 break;
 
+            case 'H':
+                Ctrl->H.active = true;
+                break;
+
+            case 'I':
+                Ctrl->I.active = true;
+                Ctrl->I.dpi = (opt->arg[0]) ? atof (opt->arg) : 300.0;
+                if (Ctrl->I.dpi <= 0.0) {
+                    GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -I option: <dpi> must be positive\n");
+                    n_errors++;
+                }
+                break;
+
+            case 'S':
+                Ctrl->S.active = true;
+                break;
+
+            case 'Q':
+                Ctrl->Q.active = true;
+                if (opt->arg[0]) strncpy (Ctrl->Q.file, opt->arg, GMT_LEN256-1);
+                break;
+
+            case 'N':
+                Ctrl->N.active = true;
+                Ctrl->N.mode = 'l';
+                Ctrl->N.bin = atof (opt->arg);
+                pos = ((c = strchr (opt->arg, '+')) != NULL) ? (unsigned int)(c - opt->arg) : 0;
+                while (c && GMT_getmodopt (GMT, opt->arg, "np", &pos, p)) {
+                    Ctrl->N.mode = p[0];
+                    Ctrl->N.order = (p[1]) ? atof (&p[1]) : 2.0;
+                }
+                if (Ctrl->N.bin <= 0.0 || (Ctrl->N.mode != 'l' && Ctrl->N.order <= 0.0)) {
+                    GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -N option: -N<bin>[+n<root>|+p<power>], with positive <bin>, <root> and <power>\n");
+                    n_errors++;
+                }
+                break;
+
+            case 'L':
+                Ctrl->L.active = true;
+                Ctrl->L.length = atof (opt->arg);
+                if (Ctrl->L.length <= 0.0) {
+                    GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -L option: <row_length> must be positive\n");
+                    n_errors++;
+                }
+                break;
+
             case 'M':
                 Ctrl->M.active = true;
                 j = sscanf(opt->arg, "%[^/]/%s", txt_a, txt_b);
@@ -291,10 +738,20 @@ int GMT_pssac_parse (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct GMT_O
                     Ctrl->M.norm = true;
                     Ctrl->M.size = GMT_to_inch (GMT, txt_a);
                 } else if (j == 2) {
-                    if (strcmp(txt_b, "s") == 0 ) {   /* -Msize/s */
-                        // TODO
-                    } else if (strcmp(txt_b, "b") == 0) {  /* -Msize/b */
-                        // TODO
+                    if (strcmp(txt_b, "g") == 0) {   /* -Msize/g */
+                        Ctrl->M.global = PSSAC_GLOBAL_MAX;
+                        Ctrl->M.size = GMT_to_inch (GMT, txt_a);
+                    } else if (strcmp(txt_b, "m") == 0) {  /* -Msize/m */
+                        Ctrl->M.global = PSSAC_GLOBAL_MEDIAN;
+                        Ctrl->M.size = GMT_to_inch (GMT, txt_a);
+                    } else if (txt_b[0] == 'p') {  /* -Msize/p<pct> */
+                        Ctrl->M.global = PSSAC_GLOBAL_PERCENTILE;
+                        Ctrl->M.size = GMT_to_inch (GMT, txt_a);
+                        Ctrl->M.percent = (txt_b[1]) ? atof (&txt_b[1]) : 95.0;
+                        if (Ctrl->M.percent <= 0.0 || Ctrl->M.percent > 100.0) {
+                            GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -M option: <pct> must be in (0, 100]\n");
+                            n_errors++;
+                        }
                     } else {  /* -Msize/alpha */
                         Ctrl->M.alpha = atof (txt_b);
                         if (Ctrl->M.alpha < 0) {
@@ -310,7 +767,7 @@ int GMT_pssac_parse (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct GMT_O
                     n_errors++;
                 }
 
-                if (GMT_IS_LINEAR(GMT) && (Ctrl->M.norm || Ctrl->M.scaleALL))
+                if (GMT_IS_LINEAR(GMT) && (Ctrl->M.norm || Ctrl->M.scaleALL || Ctrl->M.global))
                     Ctrl->M.size *= fabs((GMT->common.R.wesn[YHI]-GMT->common.R.wesn[YLO])/GMT->current.proj.pars[1]);
                 break;
 
@@ -318,12 +775,19 @@ int GMT_pssac_parse (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct GMT_O
                 pos = 0;
                 Ctrl->T.active = true;
                 Ctrl->T.shift = 0.0;  /* default no shift */
-                while (GMT_getmodopt (GMT, opt->arg, "trs", &pos, p)) {
+                while (GMT_getmodopt (GMT, opt->arg, "tprsc", &pos, p)) {
                     switch (p[0]) {
                         case 't':
                             Ctrl->T.align = true;
                             Ctrl->T.tmark = atoi (&p[1]);
                             break;
+                        case 'p':
+                            Ctrl->T.phase = (char)toupper ((int)p[1]);
+                            if (Ctrl->T.phase != 'P' && Ctrl->T.phase != 'S') {
+                                GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -T+p<phase> option: <phase> must be P or S\n");
+                                n_errors++;
+                            }
+                            break;
                         case 'r':
                             Ctrl->T.reduce = true;
                             Ctrl->T.reduce_vel = atof (&p[1]);
@@ -331,8 +795,20 @@ int GMT_pssac_parse (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct GMT_O
                         case 's':
                             Ctrl->T.shift = atof (&p[1]);
                             break;
+                        case 'c':
+                            Ctrl->T.xcorr = true;
+                            txt_a[0] = '\0';
+                            if (sscanf (&p[1], "%lf/%lf/%s", &Ctrl->T.xc_t0, &Ctrl->T.xc_t1, txt_a) < 2 || Ctrl->T.xc_t1 <= Ctrl->T.xc_t0) {
+                                GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -T+c<t0>/<t1>[/<ref>|s<niter>] option.\n");
+                                n_errors++;
+                            }
+                            if (txt_a[0] == 's')
+                                Ctrl->T.xc_niter = (txt_a[1]) ? atoi (&txt_a[1]) : 2;
+                            else if (txt_a[0])
+                                Ctrl->T.xc_ref = atoi (txt_a);
+                            break;
                         default:
-                            GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -T option: -T+t<align>+r<reduce_vel>+s<shift>");
+                            GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -T option: -T+t<align>+p<phase>+r<reduce_vel>+s<shift>+c<t0>/<t1>[/<ref>|s<niter>]");
                             n_errors++;
                             break;
                     }
@@ -350,9 +826,77 @@ int GMT_pssac_parse (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct GMT_O
                 Ctrl->v.active = true;
                 break;
 
+            case 'Z':
+                Ctrl->Z.active = true;
+                if (opt->arg[0] == 'b') Ctrl->Z.build = true;
+                break;
+
+            case 'e':
+                Ctrl->e.active = true;
+                if (opt->arg[0]) strncpy (Ctrl->e.file, opt->arg, GMT_LEN256-1);
+                if ((c = strstr (Ctrl->e.file, "+e")) != NULL) {
+                    if (sscanf (&c[2], "%f/%f/%f", &mseed_event[0], &mseed_event[1], &mseed_event[2]) < 2) {
+                        GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -e option: +e needs <evla>/<evlo>[/<evdp>]\n");
+                        n_errors++;
+                    }
+                    *c = '\0';
+                }
+                if (!Ctrl->e.file[0]) {
+                    GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -e option: no station table given\n");
+                    n_errors++;
+                }
+                break;
+
+            case 'j':
+                Ctrl->j.active = true;
+                if (opt->arg[0]) strncpy (Ctrl->j.file, opt->arg, GMT_LEN256-1);
+                if ((c = strstr (Ctrl->j.file, "+n")) != NULL) {
+                    Ctrl->j.nproc = atoi (&c[2]);
+                    *c = '\0';
+                }
+                if (!Ctrl->j.file[0]) {
+                    GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -j option: no job file given\n");
+                    n_errors++;
+                }
+                if (Ctrl->j.nproc <= 0) Ctrl->j.nproc = (int)sysconf (_SC_NPROCESSORS_ONLN);
+                if (Ctrl->j.nproc <= 0) Ctrl->j.nproc = 1;
+                break;
+
+            case 'k':
+                Ctrl->k.active = true;
+                if (opt->arg[0]) strncpy (Ctrl->k.dir, opt->arg, GMT_LEN256-1);
+                while ((c = strrchr (Ctrl->k.dir, '+')) != NULL && (c[1] == 'p' || c[1] == 'q') && c[2] == '\0') {
+                    if (c[1] == 'p') Ctrl->k.plot = true;
+                    else Ctrl->k.quant = true;
+                    *c = '\0';
+                }
+                if (!Ctrl->k.dir[0]) {
+                    GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -k option: no cache directory given\n");
+                    n_errors++;
+                }
+                break;
+
+            case 'l':
+                Ctrl->l.active = true;
+                if (opt->arg[0]) strncpy (Ctrl->l.file, opt->arg, GMT_LEN256-1);
+                else {
+                    GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -l option: no state file given\n");
+                    n_errors++;
+                }
+                break;
+
             case 'm':
                 Ctrl->m.active = true;
                 Ctrl->m.sec_per_measure = atof(opt->arg);
+                break;
+
+            case 'y':
+                Ctrl->y.active = true;
+                if (opt->arg[0]) strncpy (Ctrl->y.socket, opt->arg, GMT_LEN256-1);
+                else {
+                    GMT_Report (API, GMT_MSG_NORMAL, "Syntax error -y option: no socket given\n");
+                    n_errors++;
+                }
                 break;
 
 			default:	/* Report bad options */
@@ -361,10 +905,45 @@ int GMT_pssac_parse (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct GMT_O
 		}
 	}
 
+    if (Ctrl->k.plot) {     /* options that may change the plotted coordinates of a trace */
+        char item[GMT_BUFSIZ];
+        Ctrl->k.opt_hash = fnv1a (14695981039346656037ULL, "pssac");
+        for (opt = options; opt; opt = opt->next) {
+            if (strchr ("<BDGKOPUVWXYchkt", opt->option)) continue;
+            snprintf (item, GMT_BUFSIZ, "-%c%s ", opt->option, opt->arg);
+            Ctrl->k.opt_hash = fnv1a (Ctrl->k.opt_hash, item);
+        }
+        if (Ctrl->e.active) {   /* the station table may change under the same name */
+            struct stat st;
+            if (!stat (Ctrl->e.file, &st)) {
+                snprintf (item, GMT_BUFSIZ, "%ld %ld ", (long)st.st_mtime, (long)st.st_size);
+                Ctrl->k.opt_hash = fnv1a (Ctrl->k.opt_hash, item);
+            }
+        }
+    }
+
 	/* Check that the options selected are mutually consistent */
 
+	n_errors += GMT_check_condition (GMT, Ctrl->j.active && Ctrl->y.active, "Syntax error: -j cannot be used with -y\n");
+	n_errors += GMT_check_condition (GMT, in_job && (Ctrl->j.active || Ctrl->y.active), "Syntax error: -j and -y cannot be used in a plot job\n");
+	if (Ctrl->j.active || Ctrl->y.active) return (n_errors ? GMT_PARSE_ERROR : GMT_OK);   /* jobs bring their own options */
+
 	n_errors += GMT_check_condition (GMT, !GMT->common.R.active, "Syntax error: Must specify -R option\n");
 	n_errors += GMT_check_condition (GMT, !GMT->common.J.active, "Syntax error: Must specify a map projection with the -J option\n");
+	n_errors += GMT_check_condition (GMT, Ctrl->S.active && (Ctrl->A.active || Ctrl->T.xcorr), "Syntax error: -S cannot be used with -A or -T+c\n");
+	for (k = 0; Ctrl->S.active && k < (int)Ctrl->F.n_ops; k++)  /* operations that run across segment joins */
+		n_errors += GMT_check_condition (GMT, Ctrl->F.op[k].type != 'q' && !(Ctrl->F.op[k].type == 'b' && Ctrl->F.op[k].arg[3] == 1),
+		                                 "Syntax error: -S can only be used with the -F operations q and b with one pass, not %c\n", Ctrl->F.op[k].type);
+	n_errors += GMT_check_condition (GMT, Ctrl->l.active && (Ctrl->A.active || Ctrl->C.active || Ctrl->S.active || Ctrl->T.xcorr), "Syntax error: -l cannot be used with -A, -C, -S or -T+c\n");
+	n_errors += GMT_check_condition (GMT, Ctrl->C.n > 1 && (Ctrl->S.active || Ctrl->N.active || Ctrl->L.active || Ctrl->T.xcorr || Ctrl->Q.active),
+	                                 "Syntax error: -C cannot be given more than once with -S, -N, -L, -T+c or -Q\n");
+	n_errors += GMT_check_condition (GMT, Ctrl->Z.active && (Ctrl->A.active || Ctrl->F.active || Ctrl->l.active || Ctrl->T.xcorr), "Syntax error: -Z cannot be used with -A, -F, -l or -T+c\n");
+	n_errors += GMT_check_condition (GMT, Ctrl->N.active && (!Ctrl->E.active || !strchr ("abdku", Ctrl->E.keys[0])), "Syntax error: -N needs -Ea|b|d|k|u\n");
+	n_errors += GMT_check_condition (GMT, Ctrl->N.active && (Ctrl->S.active || Ctrl->l.active), "Syntax error: -N cannot be used with -S or -l\n");
+	n_errors += GMT_check_condition (GMT, Ctrl->Q.active && (Ctrl->A.active || Ctrl->N.active || Ctrl->S.active || Ctrl->T.xcorr || Ctrl->l.active || Ctrl->M.global),
+	                                 "Syntax error: -Q cannot be used with -A, -N, -S, -T+c, -l or -M<size>/g|m|p\n");
+	n_errors += GMT_check_condition (GMT, Ctrl->I.active && Ctrl->L.active, "Syntax error: -I cannot be used with -L\n");
+	n_errors += GMT_check_condition (GMT, Ctrl->L.active && (Ctrl->v.active || Ctrl->G.active[0] || Ctrl->G.active[1]), "Syntax error: -L cannot be used with -G or -v\n");
 
 	return (n_errors ? GMT_PARSE_ERROR : GMT_OK);
 }
@@ -479,123 +1058,2810 @@ void sqr (double *y, int n) {
     for (i=0; i<n; i++) y[i] *= y[i];
 }
 
-int init_sac_list (struct GMT_CTRL *GMT, char **files, unsigned int n_files, struct SAC_LIST **list)
+void detrend (double *y, int n)
 {
-    unsigned int n = 0, nr;
+    /* remove the least-squares linear trend */
+    int i;
+    double sy = 0.0, sxy = 0.0, sx, sxx, d, a, b;
 
-    struct SAC_LIST *L = NULL;
+    if (n < 2) return;
+    for (i=0; i<n; i++) {
+        sy  += y[i];
+        sxy += i * y[i];
+    }
+    sx  = 0.5 * n * (n - 1.0);
+    sxx = (n - 1.0) * n * (2.0 * n - 1.0) / 6.0;
+    d = n * sxx - sx * sx;
+    b = (n * sxy - sx * sy) / d;
+    a = (sy - b * sx) / n;
 
-    /* Got a bunch of SAC files or one file in SAC format */
-    if (n_files > 1 || (n_files==1 && issac(files[0]))) {
-        L = GMT_memory (GMT, NULL, n_files, struct SAC_LIST) ;
-        for (n = 0; n < n_files; n++) {
-            L[n].file = strdup (files[n]);
-            L[n].position = false;
-            L[n].custom_pen = false;
-        }
-    } else {    /* Must read a list file */
-        size_t n_alloc = 0;
-        char *line = NULL, pen[GMT_LEN256] = {""}, file[GMT_LEN256] = {""};
-        double x, y;
-        GMT_set_meminc (GMT, GMT_SMALL_CHUNK);
-        do {
-            if ((line = GMT_Get_Record(GMT->parent, GMT_READ_TEXT, NULL)) == NULL) {
-                if (GMT_REC_IS_ERROR (GMT))   /* Bail if there are any read error */
-                    return (GMT_RUNTIME_ERROR);
-                if (GMT_REC_IS_ANY_HEADER (GMT)) /* skip headers */
-                    continue;
-                if (GMT_REC_IS_EOF(GMT))  /* Reached end of file */
-                    break;
-            }
+    for (i=0; i<n; i++) y[i] -= a + b * i;
+}
 
-            nr = sscanf (line, "%s %lf %lf %s", file, &x, &y, pen);
-            if (nr < 1) {
-                GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Read error for sac list file near row %d\n", n);
-                return (EXIT_FAILURE);
-            }
+void taper (double *y, int n, double width)
+{
+    /* cosine (Hanning) taper over a fraction <width> of the data at both ends */
+    int i, m = (int)(width * n);
+    double w;
 
-            if (n == n_alloc) L = GMT_malloc (GMT, L, n, &n_alloc, struct SAC_LIST);
-            L[n].file = strdup (file);
-            if (nr>=3) {
-                L[n].position = true;
-                L[n].x = x;
-                L[n].y = y;
-            }
-            if (nr==4) {
-                L[n].custom_pen = true;
-				if (GMT_getpen (GMT, pen, &L[n].pen)) {
-					GMT_pen_syntax (GMT, 'W', "sets pen attributes [Default pen is %s]:", 3);
-				}
-            }
-            n++;
-        } while(true);
-        GMT_reset_meminc (GMT);
-        n_files = n;
+    if (m > n/2) m = n/2;
+    for (i=0; i<m; i++) {
+        w = 0.5 * (1.0 - cos (M_PI * i / m));
+        y[i]     *= w;
+        y[n-1-i] *= w;
     }
-    *list = L;
-
-    return n_files;
 }
 
-int GMT_pssac (void *V_API, int mode, void *args)
-{	/* High-level function that implements the pssac task */
-	bool old_is_world;
-	int error = GMT_NOERROR;
+struct BIQUAD {     /* second-order section, a0 normalized to 1 */
+    double b0, b1, b2, a1, a2;
+};
 
-	struct GMT_PEN current_pen;
-	struct PSSAC_CTRL *Ctrl = NULL;
-	struct GMT_CTRL *GMT = NULL, *GMT_cpy = NULL;		/* General GMT interal parameters */
-	struct GMT_OPTION *options = NULL;
-	struct PSL_CTRL *PSL = NULL;		/* General PSL interal parameters */
-	struct GMTAPI_CTRL *API = GMT_get_API_ptr (V_API);	/* Cast from void to GMTAPI_CTRL pointer */
+unsigned int butterworth (double fc, double delta, unsigned int order, bool highpass, struct BIQUAD *sec)
+{
+    /* Design a lowpass or highpass Butterworth filter of given order as cascaded
+     * biquads by bilinear transform with frequency prewarping.
+     * Return the number of sections written to sec (at most (order+1)/2). */
+    unsigned int k, n_sec = 0;
+    double K = tan (M_PI * fc * delta), Q, norm;
 
-    struct SAC_LIST *L = NULL;
-    unsigned int n_files;
-    double yscale = 1.0;
-    double y0 = 0.0, x0;
-    bool read_from_ascii;
-    int n, i;
-    SACHEAD hd;
-    float *data = NULL;
-    double *x = NULL, *y = NULL;
-    double tref;
+    for (k=0; k<order/2; k++, n_sec++) {
+        Q = -0.5 / cos (M_PI * (2.0 * k + order + 1.0) / (2.0 * order));
+        norm = 1.0 / (1.0 + K / Q + K * K);
+        if (highpass) {
+            sec[n_sec].b0 = norm;
+            sec[n_sec].b1 = -2.0 * norm;
+        } else {
+            sec[n_sec].b0 = K * K * norm;
+            sec[n_sec].b1 = 2.0 * K * K * norm;
+        }
+        sec[n_sec].b2 = sec[n_sec].b0;
+        sec[n_sec].a1 = 2.0 * (K * K - 1.0) * norm;
+        sec[n_sec].a2 = (1.0 - K / Q + K * K) * norm;
+    }
+    if (order % 2) {    /* odd order: one first-order section */
+        norm = 1.0 / (1.0 + K);
+        sec[n_sec].b0 = highpass ? norm : K * norm;
+        sec[n_sec].b1 = highpass ? -norm : K * norm;
+        sec[n_sec].b2 = sec[n_sec].a2 = 0.0;
+        sec[n_sec].a1 = (K - 1.0) * norm;
+        n_sec++;
+    }
+    return n_sec;
+}
 
-	/*----------------------- Standard module initialization and parsing ----------------------*/
+void biquad (double *y, int n, struct BIQUAD *f, double *z)
+{
+    /* run one section in place, transposed direct form II, starting from and leaving its state in z[2] */
+    int i;
+    double in, z1 = z[0], z2 = z[1];
 
-	if (API == NULL) return (GMT_NOT_A_SESSION);
-	if (mode == GMT_MODULE_PURPOSE) return (GMT_pssac_usage (API, GMT_MODULE_PURPOSE));	/* Return the purpose of program */
-	options = GMT_Create_Options (API, mode, args);	if (API->error) return (API->error);	/* Set or get option list */
+    for (i=0; i<n; i++) {
+        in   = y[i];
+        y[i] = f->b0 * in + z1;
+        z1   = f->b1 * in - f->a1 * y[i] + z2;
+        z2   = f->b2 * in - f->a2 * y[i];
+    }
+    z[0] = z1;
+    z[1] = z2;
+}
 
-	if (!options || options->option == GMT_OPT_USAGE) bailout (GMT_pssac_usage (API, GMT_USAGE));	/* Return the usage message */
-	if (options->option == GMT_OPT_SYNOPSIS) bailout (GMT_pssac_usage (API, GMT_SYNOPSIS));	/* Return the synopsis */
+void reverse (double *y, int n)
+{
+    int i;
+    double tmp;
+    for (i=0; i<n/2; i++) {
+        tmp = y[i];  y[i] = y[n-1-i];  y[n-1-i] = tmp;
+    }
+}
 
-	/* Parse the command-line arguments; return if errors are encountered */
+void bandpass (double *y, int n, double delta, double f1, double f2, unsigned int order, unsigned int passes, double *z)
+{
+    /* Butterworth bandpass as a highpass at f1 followed by a lowpass at f2.
+     * f1=0 skips the highpass, f2=0 or f2 above Nyquist skips the lowpass.
+     * passes=2 runs the cascade forward and backward for zero phase.
+     * With one pass, z holds the state of the sections, carried over from the samples
+     * before y; NULL starts from rest. */
+    unsigned int k, p, n_sec = 0;
+    struct BIQUAD sec[2*PSSAC_N_FILTERS+2];
+    double rest[2*(2*PSSAC_N_FILTERS+2)];
 
-	GMT = GMT_begin_module (API, THIS_MODULE_LIB, THIS_MODULE_NAME, &GMT_cpy); /* Save current state */
-	if (GMT_Parse_Common (API, GMT_PROG_OPTIONS, options)) Return (API->error);
+    if (f1 > 0.0) n_sec += butterworth (f1, delta, order, true, &sec[n_sec]);
+    if (f2 > 0.0 && f2 < 0.5 / delta) n_sec += butterworth (f2, delta, order, false, &sec[n_sec]);
 
-	Ctrl = New_pssac_Ctrl (GMT);	/* Allocate and initialize a new control structure */
-	if ((error = GMT_pssac_parse (GMT, Ctrl, options)) != 0) Return (error);
+    for (p=0; p<passes; p++) {
+        if (p) reverse (y, n);
+        if (p || z == NULL) {
+            memset (rest, 0, sizeof (rest));
+            for (k=0; k<n_sec; k++) biquad (y, n, &sec[k], &rest[2*k]);
+        } else
+            for (k=0; k<n_sec; k++) biquad (y, n, &sec[k], &z[2*k]);
+        if (p) reverse (y, n);
+    }
+}
 
+void envelope (struct GMT_CTRL *GMT, double *y, int n, double delta, double win)
+{
+    /* smoothed envelope: running mean of |y| over a window of win seconds */
+    int i, h = (int)(0.5 * win / delta);
+    double *s = GMT_memory (GMT, NULL, n+1, double);
 
-	/*---------------------------- This is the pssac main code ----------------------------*/
+    s[0] = 0.0;     /* prefix sums of |y| */
+    for (i=0; i<n; i++) s[i+1] = s[i] + fabs (y[i]);
+    for (i=0; i<n; i++) {
+        int i0 = MAX (i-h, 0), i1 = MIN (i+h+1, n);
+        y[i] = (s[i1] - s[i0]) / (i1 - i0);
+    }
+    GMT_free (GMT, s);
+}
 
-	current_pen = Ctrl->W.pen;
+int decimate (double *y, int n, double delta, int factor)
+{
+    /* decimate by an integer factor after a zero-phase anti-alias lowpass.
+     * Return the new number of samples. */
+    int i, m;
 
-	if (GMT_err_pass (GMT, GMT_map_setup (GMT, GMT->common.R.wesn), "")) Return (GMT_PROJECTION_ERROR);
+    if (factor <= 1) return n;
+    bandpass (y, n, delta, 0.0, 0.4 / (delta * factor), 4, 2, NULL);
+    m = (n - 1) / factor + 1;
+    for (i=0; i<m; i++) y[i] = y[i*factor];
+    return m;
+}
 
-	if ((PSL = GMT_plotinit (GMT, options)) == NULL) Return (GMT_RUNTIME_ERROR);
+struct PSSAC_FFT_PLAN *fft_plan (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, unsigned int n)
+{
+    /* Return the cached tables for a FFT of length n (a power of 2), creating them on first use.
+     * All traces with the same padded length share one plan. */
+    unsigned int k, j, bits = 0;
+    struct PSSAC_FFT_PLAN *P = NULL;
 
-	GMT_plane_perspective (GMT, GMT->current.proj.z_project.view_plane, GMT->current.proj.z_level);
-	GMT_plotcanvas (GMT);	/* Fill canvas if requested */
+#ifdef _OPENMP
+#pragma omp critical (pssac_fft_plan)
+#endif
+    {
+        for (k = 0; k < Ctrl->F.n_plans; k++)
+            if (Ctrl->F.plan[k].n == n) P = &Ctrl->F.plan[k];
 
-	GMT_setpen (GMT, &current_pen);
+        if (P == NULL && Ctrl->F.n_plans < PSSAC_N_PLANS) {
+            P = &Ctrl->F.plan[Ctrl->F.n_plans];
+            while ((1U << bits) < n) bits++;
+            P->rev = GMT_memory (GMT, NULL, n, unsigned int);
+            P->wr  = GMT_memory (GMT, NULL, n/2, double);
+            P->wi  = GMT_memory (GMT, NULL, n/2, double);
+            for (k = 0; k < n; k++) {
+                for (j = 0, P->rev[k] = 0; j < bits; j++)
+                    if (k & (1U << j)) P->rev[k] |= 1U << (bits - 1 - j);
+            }
+            for (k = 0; k < n/2; k++) {
+                P->wr[k] =  cos (2.0 * M_PI * k / n);
+                P->wi[k] = -sin (2.0 * M_PI * k / n);
+            }
+            P->n = n;
+            Ctrl->F.n_plans++;
+            GMT_Report (GMT->parent, GMT_MSG_LONG_VERBOSE, "Created FFT plan for length %u\n", n);
+        }
+    }
+    return P;
+}
+
+void fft (struct PSSAC_FFT_PLAN *P, double *re, double *im, bool inverse)
+{
+    /* In-place iterative radix-2 complex FFT. The inverse is scaled by 1/n. */
+    unsigned int i, j, k, m, half, step, n = P->n;
+    double tr, ti, wr, wi;
+
+    for (i = 0; i < n; i++) {
+        if ((j = P->rev[i]) > i) {
+            tr = re[i];  re[i] = re[j];  re[j] = tr;
+            ti = im[i];  im[i] = im[j];  im[j] = ti;
+        }
+    }
+    for (m = 2; m <= n; m <<= 1) {
+        half = m / 2;
+        step = n / m;
+        for (i = 0; i < n; i += m) {
+            for (k = 0; k < half; k++) {
+                wr = P->wr[k*step];
+                wi = inverse ? -P->wi[k*step] : P->wi[k*step];
+                j = i + k + half;
+                tr = wr * re[j] - wi * im[j];
+                ti = wr * im[j] + wi * re[j];
+                re[j] = re[i+k] - tr;
+                im[j] = im[i+k] - ti;
+                re[i+k] += tr;
+                im[i+k] += ti;
+            }
+        }
+    }
+    if (inverse) {
+        for (i = 0; i < n; i++) {
+            re[i] /= n;
+            im[i] /= n;
+        }
+    }
+}
+
+double cosine_window (double f, double f1, double f2, double f3, double f4)
+{
+    /* 0 outside [f1,f4], 1 inside [f2,f3] and cosine tapered in between */
+    if (f < f1 || f > f4) return 0.0;
+    if (f < f2) return 0.5 * (1.0 - cos (M_PI * (f - f1) / (f2 - f1)));
+    if (f > f3) return 0.5 * (1.0 + cos (M_PI * (f - f3) / (f4 - f3)));
+    return 1.0;
+}
+
+void spectral (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct PSSAC_FILTER *F, double *y, int npts, double delta)
+{
+    /* Frequency-domain operations of -F: Hilbert envelope (h), whitening (w) and bandpass (f) */
+    unsigned int n = 1, k, i0, i1, h;
+    double *re = NULL, *im = NULL, *amp = NULL, df, g, s;
+    struct PSSAC_FFT_PLAN *P = NULL;
+
+    while (n < (unsigned int)npts) n <<= 1;
+    if ((P = fft_plan (GMT, Ctrl, n)) == NULL) {
+        GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Warning: too many different trace lengths, -F%c skipped.\n", F->type);
+        return;
+    }
+    re = GMT_memory (GMT, NULL, n, double);
+    im = GMT_memory (GMT, NULL, n, double);
+    memcpy (re, y, npts * sizeof (double));
+    df = 1.0 / (n * delta);
+
+    fft (P, re, im, false);
+    switch (F->type) {
+        case 'h':   /* analytic signal: double positive, zero negative frequencies */
+            for (k = 1; k < n/2; k++) {
+                re[k] *= 2.0;  im[k] *= 2.0;
+                re[n-k] = im[n-k] = 0.0;
+            }
+            break;
+        case 'w':   /* divide by the (smoothed) amplitude spectrum */
+            amp = GMT_memory (GMT, NULL, n/2 + 2, double);
+            for (k = 0; k <= n/2; k++) amp[k+1] = amp[k] + hypot (re[k], im[k]);    /* prefix sums */
+            h = (unsigned int)(0.5 * F->arg[0] / df);
+            for (k = 0; k <= n/2; k++) {
+                i0 = (k > h) ? k - h : 0;
+                i1 = MIN (k + h + 1, n/2 + 1);
+                s = (amp[i1] - amp[i0]) / (i1 - i0);
+                g = (s > 0.0) ? 1.0 / s : 0.0;
+                re[k] *= g;  im[k] *= g;
+                if (k > 0 && k < n/2) {
+                    re[n-k] *= g;  im[n-k] *= g;
+                }
+            }
+            GMT_free (GMT, amp);
+            break;
+        case 'f':
+            for (k = 0; k <= n/2; k++) {
+                g = cosine_window (k * df, F->arg[0], F->arg[1], F->arg[2], F->arg[3]);
+                re[k] *= g;  im[k] *= g;
+                if (k > 0 && k < n/2) {
+                    re[n-k] *= g;  im[n-k] *= g;
+                }
+            }
+            break;
+    }
+    fft (P, re, im, true);
+
+    if (F->type == 'h')
+        for (k = 0; k < (unsigned int)npts; k++) y[k] = hypot (re[k], im[k]);
+    else
+        memcpy (y, re, npts * sizeof (double));
+    GMT_free (GMT, re);
+    GMT_free (GMT, im);
+}
+
+void sac_preprocess (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, double *y, SACHEAD *hd)
+{
+    /* -F: run the data processing chain in place on the trace */
+    unsigned int k;
+    struct PSSAC_FILTER *F = NULL;
+
+    for (k=0; k<Ctrl->F.n_ops; k++) {
+        F = &Ctrl->F.op[k];
+        switch (F->type) {
+            case 'i': integral(y, hd->delta, hd->npts); hd->npts--; break;
+            case 'q':   sqr(y, hd->npts); break;
+            case 'r': rmean(y, hd->npts); break;
+            case 'd': detrend(y, hd->npts); break;
+            case 't': taper(y, hd->npts, F->arg[0]); break;
+            case 'b': bandpass(y, hd->npts, hd->delta, F->arg[0], F->arg[1], (unsigned int)F->arg[2], (unsigned int)F->arg[3], NULL); break;
+            case 'e': envelope(GMT, y, hd->npts, hd->delta, F->arg[0]); break;
+            case 's':
+                hd->npts = decimate(y, hd->npts, hd->delta, (int)F->arg[0]);
+                hd->delta *= (int)F->arg[0];
+                hd->e = hd->b + (hd->npts - 1) * hd->delta;
+                break;
+            case 'h': case 'w': case 'f':
+                spectral(GMT, Ctrl, F, y, hd->npts, hd->delta);
+                break;
+            default: break;
+        }
+    }
+}
+
+void distaz (int n, const double *evla, const double *evlo, const double *stla, const double *stlo,
+             double *gcarc, double *az, double *baz, double *dist)
+{
+    /* Great circle distance (degree and km) and azimuths for n station-event pairs,
+     * on a sphere of radius 6371 km with geocentric latitudes. One branch-free loop. */
+    int i;
+    const double e = (1.0 - 1.0/298.257223563) * (1.0 - 1.0/298.257223563);   /* WGS84 (1-f)^2 */
+
+    for (i = 0; i < n; i++) {
+        double le = atan (e * tan (evla[i] * D2R)), ls = atan (e * tan (stla[i] * D2R));
+        double dlon = (stlo[i] - evlo[i]) * D2R;
+        double se = sin (le), ce = cos (le), ss = sin (ls), cs = cos (ls);
+        double sd = sin (dlon), cd = cos (dlon);
+        double a = cs * sd, b = ce * ss - se * cs * cd, c = se * ss + ce * cs * cd;
+
+        gcarc[i] = atan2 (sqrt (a * a + b * b), c) * R2D;
+        az[i]  = fmod (atan2 (a, b) * R2D + 360.0, 360.0);
+        baz[i] = fmod (atan2 (-ce * sd, cs * se - ss * ce * cd) * R2D + 360.0, 360.0);
+        dist[i] = gcarc[i] * D2R * 6371.0;
+    }
+}
+
+int raw_find (const char *file)
+{
+    /* index of file in the raw cache, up to date or not, or -1 */
+    int i, k;
+    if (n_raw_index == 0) return -1;
+    for (i = (int)(fnv1a (14695981039346656037ULL, file) & (n_raw_index - 1)); (k = raw_index[i]) >= 0; i = (i + 1) & (n_raw_index - 1))
+        if (!strcmp (raw_cache[k].file, file)) return k;
+    return -1;
+}
+
+void raw_reindex (void)
+{
+    /* rebuild raw_index after entries were added or moved, by linear probing */
+    int i, k;
+    if (n_raw_index < 2 * n_raw_alloc) {
+        while (n_raw_index < 2 * n_raw_alloc) n_raw_index = (n_raw_index) ? 2 * n_raw_index : 2 * GMT_SMALL_CHUNK;
+        raw_index = realloc (raw_index, n_raw_index * sizeof (int));
+    }
+    for (i = 0; i < n_raw_index; i++) raw_index[i] = -1;
+    for (k = 0; k < n_raw; k++) {
+        for (i = (int)(fnv1a (14695981039346656037ULL, raw_cache[k].file) & (n_raw_index - 1)); raw_index[i] >= 0; i = (i + 1) & (n_raw_index - 1));
+        raw_index[i] = k;
+    }
+}
+
+int raw_lookup (const char *file)
+{
+    /* index of file in the raw cache, or -1 if it is not there or has changed since */
+    int k;
+    struct stat st;
+    if ((k = raw_find (file)) < 0) return -1;
+    if (raw_cache[k].borrowed) return k;
+    if (stat (file, &st) || raw_cache[k].mtime != st.st_mtime || raw_cache[k].size != st.st_size) return -1;
+    return k;
+}
+
+void drop_raw (int k)
+{
+    /* remove entry k from the raw cache */
+    if (!raw_cache[k].borrowed) {
+        raw_bytes -= (size_t)raw_cache[k].hd.npts * sizeof (float);
+        free (raw_cache[k].data);
+    }
+    free (raw_cache[k].file);
+    memmove (&raw_cache[k], &raw_cache[k+1], (n_raw - k - 1) * sizeof (struct PSSAC_RAW));
+    n_raw--;
+    raw_reindex ();     /* the later entries moved down */
+}
+
+void drop_raw_prefix (const char *prefix)
+{
+    /* remove all entries of the raw cache whose name starts with prefix, in one pass */
+    int k, m = 0;
+    size_t len = strlen (prefix);
+
+    for (k = 0; k < n_raw; k++) {
+        if (strncmp (raw_cache[k].file, prefix, len)) {
+            raw_cache[m++] = raw_cache[k];
+            continue;
+        }
+        if (!raw_cache[k].borrowed) {
+            raw_bytes -= (size_t)raw_cache[k].hd.npts * sizeof (float);
+            free (raw_cache[k].data);
+        }
+        free (raw_cache[k].file);
+    }
+    n_raw = m;
+    raw_reindex ();
+}
+
+int add_raw (const char *file)
+{
+    /* append an empty entry for file to the raw cache and return its index */
+    int i;
+    if (n_raw == n_raw_alloc) {
+        n_raw_alloc = (n_raw_alloc) ? 2 * n_raw_alloc : GMT_SMALL_CHUNK;
+        raw_cache = realloc (raw_cache, n_raw_alloc * sizeof (struct PSSAC_RAW));
+        raw_reindex ();
+    }
+    memset (&raw_cache[n_raw], 0, sizeof (struct PSSAC_RAW));
+    raw_cache[n_raw].file = strdup (file);
+    for (i = (int)(fnv1a (14695981039346656037ULL, file) & (n_raw_index - 1)); raw_index[i] >= 0; i = (i + 1) & (n_raw_index - 1));
+    raw_index[i] = n_raw;
+    return n_raw++;
+}
+
+int pssac_register_trace (const char *name, const SACHEAD *hd, float *data)
+{
+    /* Make hd->npts samples in data available to pssac as the file name, which must
+     * start with PSSAC_MEM_PREFIX. The samples are not copied. Return 0, or -1 on a bad name. */
+    int k;
+    if (strncmp (name, PSSAC_MEM_PREFIX, strlen (PSSAC_MEM_PREFIX)) || !data || hd->npts <= 0) return -1;
+    if ((k = raw_find (name)) < 0) k = add_raw (name);
+    raw_cache[k].borrowed = true;
+    raw_cache[k].hd = *hd;
+    raw_cache[k].data = data;
+    return 0;
+}
+
+int pssac_unregister_trace (const char *name)
+{
+    /* Forget a trace registered by pssac_register_trace. Return 0, or -1 if it is unknown. */
+    int k;
+    if ((k = raw_find (name)) < 0 || !raw_cache[k].borrowed) return -1;
+    drop_raw (k);
+    return 0;
+}
+
+int open_mseed (const char *file)
+{
+    /* Decode a miniSEED file into the raw cache unless an up-to-date copy is there.
+     * Return its index, or -1 if file is not miniSEED. */
+    int k;
+    struct stat st;
+    SACHEAD hd;
+    float *data;
+
+    if ((k = raw_lookup (file)) >= 0) return (raw_cache[k].mseed) ? k : -1;
+    if (stat (file, &st) || !ismseed (file) || (data = read_mseed (file, &hd)) == NULL) return -1;
+    if ((k = raw_find (file)) >= 0) drop_raw (k);    /* the outdated copy */
+    k = add_raw (file);
+    raw_cache[k].mseed = true;
+    raw_cache[k].mtime = st.st_mtime;
+    raw_cache[k].size = st.st_size;
+    raw_cache[k].hd = hd;
+    raw_cache[k].data = data;
+    raw_bytes += (size_t)hd.npts * sizeof (float);
+    return k;
+}
+
+int read_stations (struct GMT_CTRL *GMT, char *file)
+{
+    /* -e: read the station table of miniSEED data, one station per record <net> <sta> <lat> <lon> [<elev>] */
+    char line[GMT_BUFSIZ];
+    int n_alloc = 0;
+    FILE *fp;
+
+    if ((fp = fopen (file, "r")) == NULL) {
+        GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Cannot open station table %s\n", file);
+        return -1;
+    }
+    n_stations = 0;
+    while (fgets (line, GMT_BUFSIZ, fp)) {
+        if (n_stations == n_alloc) {
+            n_alloc = (n_alloc) ? 2 * n_alloc : GMT_SMALL_CHUNK;
+            stations = realloc (stations, n_alloc * sizeof (struct PSSAC_STATION));
+        }
+        stations[n_stations].elev = 0.0;
+        if (line[0] == '#' || sscanf (line, "%8s %8s %f %f %f", stations[n_stations].net, stations[n_stations].sta,
+                &stations[n_stations].lat, &stations[n_stations].lon, &stations[n_stations].elev) < 4) continue;
+        n_stations++;
+    }
+    fclose (fp);
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Read %d stations from %s\n", n_stations, file);
+    return 0;
+}
+
+void set_station (SACHEAD *hd)
+{
+    /* -e: station coordinates of a miniSEED trace from the station table, and the event location */
+    int k;
+    for (k = 0; k < n_stations; k++) {
+        if (strcmp (stations[k].net, hd->knetwk) || strcmp (stations[k].sta, hd->kstnm)) continue;
+        hd->stla = stations[k].lat;
+        hd->stlo = stations[k].lon;
+        hd->stel = stations[k].elev;
+        break;
+    }
+    if (mseed_event[0] != SAC_FLOAT_UNDEF) {
+        hd->evla = mseed_event[0];
+        hd->evlo = mseed_event[1];
+        if (mseed_event[2] != SAC_FLOAT_UNDEF) hd->evdp = mseed_event[2];
+    }
+}
+
+int open_bundle (const char *file)
+{
+    /* Read a SAC bundle, memory mapped if possible, and put its traces into the raw cache
+     * as <file>#<member>. Return the index of the bundle, or -1 if file is not a bundle.
+     * A bundle is read only once unless the file has changed since. */
+    int b, i, k;
+    char name[GMT_BUFSIZ];
+    struct stat st;
+
+    if (stat (file, &st)) return -1;
+    for (b = 0; b < n_bundles && strcmp (bundles[b].file, file); b++);
+    if (b < n_bundles) {
+        if (bundles[b].mtime == st.st_mtime && bundles[b].size == st.st_size) return b;
+        snprintf (name, GMT_BUFSIZ, "%s#", file);   /* the outdated copy */
+        drop_raw_prefix (name);
+        free_sac_bundle (&bundles[b].bd);
+        free (bundles[b].file);
+        bundles[b] = bundles[--n_bundles];
+    }
+    if (!issacbundle (file)) return -1;
+
+    b = n_bundles;
+    bundles = realloc (bundles, (n_bundles + 1) * sizeof (struct PSSAC_BUNDLE));
+    if (read_sac_bundle (file, &bundles[b].bd, true)) return -1;
+    bundles[b].file = strdup (file);
+    bundles[b].mtime = st.st_mtime;
+    bundles[b].size = st.st_size;
+    n_bundles++;
+    for (i = 0; i < bundles[b].bd.n; i++) {
+        snprintf (name, GMT_BUFSIZ, "%s#%s", file, bundles[b].bd.member[i]);
+        if ((k = raw_find (name)) < 0) k = add_raw (name);
+        raw_cache[k].borrowed = true;
+        raw_cache[k].hd = bundles[b].bd.hd[i];
+        raw_cache[k].data = bundles[b].bd.data[i];
+    }
+    return b;
+}
+
+bool is_bundle_member (const char *file)
+{
+    /* true if file is <bundle>#<member> and that trace is in the bundle */
+    char bundle[GMT_BUFSIZ], *c;
+
+    strncpy (bundle, file, GMT_BUFSIZ - 1);
+    bundle[GMT_BUFSIZ-1] = '\0';
+    if ((c = strrchr (bundle, '#')) == NULL) return false;
+    *c = '\0';
+    return open_bundle (bundle) >= 0 && raw_lookup (file) >= 0;
+}
+
+bool is_trace (const char *file)
+{
+    /* true if file is a SAC file, a SAC bundle, a trace in a bundle, a miniSEED file or a registered trace */
+    if (!strncmp (file, PSSAC_MEM_PREFIX, strlen (PSSAC_MEM_PREFIX))) return raw_lookup (file) >= 0;
+    return is_bundle_member (file) || issac (file) || open_bundle (file) >= 0 || open_mseed (file) >= 0;
+}
+
+int compare_names (const void *p1, const void *p2)
+{
+    return strcmp (*(char * const *)p1, *(char * const *)p2);
+}
+
+int file_place (const char *file, int n, off_t min_size, struct PSSAC_PLACE *P)
+{
+    /* device, first extent and inode of file. The extent comes from FIEMAP on Linux;
+     * elsewhere, or on filesystems without it, the inode order stands in for it.
+     * Return 1 if the file is smaller than min_size, then only stat is called. */
+    struct stat st;
+
+    memset (P, 0, sizeof (struct PSSAC_PLACE));
+    P->n = n;
+    if (stat (file, &st)) return (min_size > 0);   /* e.g. a bundle member, read from memory */
+    P->dev = st.st_dev;
+    P->ino = st.st_ino;
+    if (st.st_size < min_size) return 1;
+#if defined(__linux__) && defined(FS_IOC_FIEMAP)
+    {
+        uint64_t buf[(sizeof (struct fiemap) + sizeof (struct fiemap_extent)) / sizeof (uint64_t) + 1];
+        struct fiemap *fm = (struct fiemap *)buf;
+        int fd;
+        if ((fd = open (file, O_RDONLY)) < 0) return 0;
+        memset (buf, 0, sizeof (buf));
+        fm->fm_length = FIEMAP_MAX_OFFSET;
+        fm->fm_extent_count = 1;
+        if (ioctl (fd, FS_IOC_FIEMAP, fm) == 0 && fm->fm_mapped_extents > 0)
+            P->extent = fm->fm_extents[0].fe_physical;
+        close (fd);
+    }
+#endif
+    return 0;
+}
+
+int compare_places (const void *p1, const void *p2)
+{
+    const struct PSSAC_PLACE *a = p1, *b = p2;
+    if (a->dev != b->dev) return (a->dev < b->dev) ? -1 : 1;
+    if (a->extent != b->extent) return (a->extent < b->extent) ? -1 : 1;
+    if (a->ino != b->ino) return (a->ino < b->ino) ? -1 : 1;
+    return a->n - b->n;
+}
+
+void warm_raw_traces (struct GMT_CTRL *GMT, char **files, int n_files)
+{
+    /* -y/-j: read whole SAC files into the raw cache unless up-to-date copies are there, in parallel
+     * if OpenMP is available. Files are read in disk order, in chunks of at most PSSAC_CHUNK files
+     * and PSSAC_RAW_MAX/8 bytes, so memory stays near PSSAC_RAW_MAX however many files there are.
+     * When the cache is full the oldest entries are dropped, but never those of files passed in this
+     * call; files that do not fit then are read from disk by the jobs. files is sorted on return. */
+    int i, i0, n, k, m;
+    off_t bytes;
+    size_t need;
+    struct stat *st = GMT_memory (GMT, NULL, n_files, struct stat);
+    SACHEAD *hd = GMT_memory (GMT, NULL, n_files, SACHEAD);
+    float **data = GMT_memory (GMT, NULL, n_files, float *);
+    bool *todo = GMT_memory (GMT, NULL, n_files, bool);
+    struct PSSAC_PLACE *P = GMT_memory (GMT, NULL, n_files, struct PSSAC_PLACE);
+
+    qsort (files, n_files, sizeof (char *), compare_names);
+    for (k = 0; k < n_raw; k++) raw_cache[k].pinned = false;
+    for (n = 0; n < n_files; n++) {
+        file_place (files[n], n, 0, &P[n]);
+        if (n > 0 && !strcmp (files[n], files[n-1])) continue;
+        if ((k = raw_lookup (files[n])) >= 0)
+            raw_cache[k].pinned = true;
+        else
+            todo[n] = !stat (files[n], &st[n]) && issac (files[n]) == 1;
+    }
+    qsort (P, n_files, sizeof (struct PSSAC_PLACE), compare_places);    /* read in disk order */
+
+    for (i0 = 0; i0 < n_files; i0 = i) {
+        /* files P[i0..i-1] */
+        for (i = i0, m = 0, bytes = 0; i < n_files && m < PSSAC_CHUNK && (m == 0 || bytes < (off_t)(PSSAC_RAW_MAX / 8)); i++)
+            if (todo[P[i].n]) {
+                m++;
+                bytes += st[P[i].n].st_size;
+            }
+#ifdef _OPENMP
+#pragma omp parallel for private(k,n) shared(files,st,hd,data,todo,P,i0,i) schedule(dynamic)
+#endif
+        for (k = i0; k < i; k++) {
+            n = P[k].n;
+            if (todo[n]) data[n] = read_sac (files[n], &hd[n]);
+        }
+
+        for (k = i0; k < i; k++) {
+            n = P[k].n;
+            if (data[n] == NULL) continue;
+            need = (size_t)hd[n].npts * sizeof (float);
+            if ((m = raw_find (files[n])) >= 0) drop_raw (m);    /* the outdated copy */
+            for (m = 0; m < n_raw && raw_bytes + need > PSSAC_RAW_MAX; )
+                if (raw_cache[m].borrowed || raw_cache[m].pinned) m++;
+                else drop_raw (m);
+            if (raw_bytes + need > PSSAC_RAW_MAX) {
+                GMT_Report (GMT->parent, GMT_MSG_LONG_VERBOSE, "=> %s: no room in memory, read by the jobs\n", files[n]);
+                free (data[n]);
+                data[n] = NULL;
+                continue;
+            }
+            m = add_raw (files[n]);
+            raw_cache[m].mtime = st[n].st_mtime;
+            raw_cache[m].size = st[n].st_size;
+            raw_cache[m].hd = hd[n];
+            raw_cache[m].data = data[n];
+            raw_cache[m].pinned = true;
+            raw_bytes += need;
+            data[n] = NULL;
+            GMT_Report (GMT->parent, GMT_MSG_LONG_VERBOSE, "=> %s: kept in memory\n", files[n]);
+        }
+    }
+    GMT_free (GMT, P);
+    GMT_free (GMT, todo);
+    GMT_free (GMT, st);
+    GMT_free (GMT, hd);
+    GMT_free (GMT, data);
+}
+
+int read_sac_head_cached (char *file, SACHEAD *hd)
+{
+    /* read_sac_head, from the raw cache if the file is there */
+    int k;
+    if ((k = raw_lookup (file)) < 0) return read_sac_head (file, hd);
+    *hd = raw_cache[k].hd;
+    if (raw_cache[k].mseed) set_station (hd);
+    return 0;
+}
+
+double *raw_window (struct GMT_CTRL *GMT, struct PSSAC_RAW *R, SACHEAD *hd, bool cut, float t1, float t2)
+{
+    /* all samples of a file in the raw cache, or the window t1 to t2 zero padded like read_sac_pdw */
+    int i, nt1 = 0, nt2, nn;
+    double *y;
+
+    *hd = R->hd;
+    if (R->mseed) set_station (hd);
+    if (cut) {
+        if ((nn = (int)((t2-t1)/hd->delta)) <= 0) return NULL;
+        nt1 = (int)((t1 - hd->b) / hd->delta);
+        hd->npts = nn;
+        hd->b = t1;
+        hd->e = t1 + nn * hd->delta;
+    }
+    y = GMT_memory (GMT, NULL, hd->npts, double);
+    nt2 = MIN (nt1 + hd->npts, R->hd.npts);
+    for (i = MAX (nt1, 0); i < nt2; i++) y[i-nt1] = R->data[i];
+    return y;
+}
+
+void set_geometry (struct SAC_LIST *L, SACHEAD *hd)
+{
+    /* fill undefined gcarc, az, baz and dist from the values computed by complete_geometry */
+    if (!L->has_geom) return;
+    if (hd->gcarc == SAC_FLOAT_UNDEF) hd->gcarc = L->geom[0];
+    if (hd->az    == SAC_FLOAT_UNDEF) hd->az    = L->geom[1];
+    if (hd->baz   == SAC_FLOAT_UNDEF) hd->baz   = L->geom[2];
+    if (hd->dist  == SAC_FLOAT_UNDEF) hd->dist  = L->geom[3];
+}
+
+void complete_geometry (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, int n_files)
+{
+    /* Header prepass: compute gcarc, az, baz and dist of all traces that lack any of them
+     * but have station and event coordinates. With -H, patch the headers in place. */
+    int n, m = 0, k;
+    int *idx = GMT_memory (GMT, NULL, n_files, int);
+    double *in = GMT_memory (GMT, NULL, 8 * n_files, double);
+    SACHEAD *hd = GMT_memory (GMT, NULL, n_files, SACHEAD);
+    bool *need = GMT_memory (GMT, NULL, n_files, bool);
+
+#ifdef _OPENMP
+#pragma omp parallel for private(n) shared(L,n_files,hd,need)
+#endif
+    for (n = 0; n < n_files; n++) {
+        need[n] = false;
+        if (L[n].bad || read_sac_head_cached (L[n].file, &hd[n])) continue;
+        need[n] = (hd[n].gcarc == SAC_FLOAT_UNDEF || hd[n].az == SAC_FLOAT_UNDEF ||
+                   hd[n].baz == SAC_FLOAT_UNDEF || hd[n].dist == SAC_FLOAT_UNDEF) &&
+                  hd[n].evla != SAC_FLOAT_UNDEF && hd[n].evlo != SAC_FLOAT_UNDEF &&
+                  hd[n].stla != SAC_FLOAT_UNDEF && hd[n].stlo != SAC_FLOAT_UNDEF;
+    }
+
+    /* gather coordinates of the traces to complete into contiguous arrays */
+    for (n = 0; n < n_files; n++) if (need[n]) idx[m++] = n;
+    for (k = 0; k < m; k++) {
+        in[k]       = hd[idx[k]].evla;
+        in[k+m]     = hd[idx[k]].evlo;
+        in[k+2*m]   = hd[idx[k]].stla;
+        in[k+3*m]   = hd[idx[k]].stlo;
+    }
+    distaz (m, in, in+m, in+2*m, in+3*m, in+4*m, in+5*m, in+6*m, in+7*m);
+
+    for (k = 0; k < m; k++) {
+        n = idx[k];
+        L[n].has_geom = true;
+        L[n].geom[0] = (float)in[k+4*m];
+        L[n].geom[1] = (float)in[k+5*m];
+        L[n].geom[2] = (float)in[k+6*m];
+        L[n].geom[3] = (float)in[k+7*m];
+        GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: computed gcarc=%g az=%g baz=%g dist=%g\n",
+                    L[n].file, L[n].geom[0], L[n].geom[1], L[n].geom[2], L[n].geom[3]);
+        if (Ctrl->H.active) {
+            set_geometry (&L[n], &hd[n]);
+            if (write_sac_head (L[n].file, hd[n]))
+                GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: unable to update SAC header.\n", L[n].file);
+        }
+    }
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Computed geometry of %d traces%s.\n", m, Ctrl->H.active ? " and updated their headers" : "");
+
+    GMT_free (GMT, idx);
+    GMT_free (GMT, in);
+    GMT_free (GMT, hd);
+    GMT_free (GMT, need);
+}
+
+int sac_reference_time (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, char *file, SACHEAD *hd, double *tref)
+{
+    /* -T: determine the reference time for all times in pssac */
+    *tref = 0.0;
+    if (!Ctrl->T.active) return 0;
+
+    /* +t */
+    if (Ctrl->T.align) *tref += *((float *)hd + TMARK + Ctrl->T.tmark);
+    /* +p */
+    if (Ctrl->T.phase) {
+        double evdp = (hd->evdp == SAC_FLOAT_UNDEF) ? 0.0 : hd->evdp, tt;
+        if (hd->o == SAC_FLOAT_UNDEF || hd->gcarc == SAC_FLOAT_UNDEF) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: o or gcarc not defined in SAC header, skipped.\n", file);
+            return 1;
+        }
+        if (evdp > 1000.0) evdp /= 1000.0;  /* evdp in meters in older SAC files */
+        if ((tt = ttable_lookup (Ctrl->T.phase, hd->gcarc, evdp)) < 0.0) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: gcarc=%g out of range of travel time table, skipped.\n", file, hd->gcarc);
+            return 1;
+        }
+        *tref += hd->o + tt;
+    }
+    /* +r */
+    if (Ctrl->T.reduce) {
+        if (hd->dist == SAC_FLOAT_UNDEF) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: dist not defined in SAC header, skipped.\n", file);
+            return 1;
+        }
+        *tref += fabs(hd->dist)/Ctrl->T.reduce_vel;
+    }
+    /* +s */
+    *tref -= Ctrl->T.shift;
+    return 0;
+}
+
+float *read_sac_window (struct PSSAC_CTRL *Ctrl, char *file, SACHEAD *hd, double tref, int win)
+{
+    /* read the whole trace, or the -C window win relative to tref */
+    if (!Ctrl->C.active) return read_sac (file, hd);
+    return read_sac_pdw (file, hd, 10, tref+Ctrl->C.t0[win], tref+Ctrl->C.t1[win]);
+}
+
+double *read_trace (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, char *file, SACHEAD *hd, double tref, int win)
+{
+    /* read_sac_window as doubles, straight from memory for files in the raw cache */
+    int i, k;
+    float *data = NULL;
+    double *y = NULL;
+
+    if ((k = raw_lookup (file)) >= 0)
+        return raw_window (GMT, &raw_cache[k], hd, Ctrl->C.active, tref+Ctrl->C.t0[win], tref+Ctrl->C.t1[win]);
+    if ((data = read_sac_window (Ctrl, file, hd, tref, win)) == NULL) return NULL;
+    y = GMT_memory(GMT, 0, hd->npts, double);
+    for (i=0; i<hd->npts; i++) y[i] = data[i];
+    free (data);
+    return y;
+}
+
+double *read_windows (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, SACHEAD *hd)
+{
+    /* -C with several windows: L[0..C.n-1] are the windows of one file. Read them all with one open,
+     * keep windows 1 and up in their entries for load_sac_trace, and return window 0 as doubles. */
+    int i, k;
+    float t0[PSSAC_N_WINDOWS], t1[PSSAC_N_WINDOWS], *ar[PSSAC_N_WINDOWS];
+    SACHEAD whd[PSSAC_N_WINDOWS];
+    double *y = NULL;
+
+    for (k = 0; k < Ctrl->C.n; k++) {
+        t0[k] = (float)(L->tref + Ctrl->C.t0[k]);
+        t1[k] = (float)(L->tref + Ctrl->C.t1[k]);
+    }
+    if (read_sac_windows (L->file, Ctrl->C.n, t0, t1, whd, ar)) return NULL;
+    for (k = 0; k < Ctrl->C.n; k++) {
+        double *w = GMT_memory (GMT, NULL, whd[k].npts, double);
+        for (i = 0; i < whd[k].npts; i++) w[i] = ar[k][i];
+        free (ar[k]);
+        if (k == 0) {
+            *hd = whd[0];
+            y = w;
+        } else if (L[k].loaded || L[k].bad)
+            GMT_free (GMT, w);
+        else {
+            L[k].hd = whd[k];
+            L[k].data = w;
+            L[k].prefetched = true;
+            L[k].tref = L->tref;    /* same file, so load_sac_trace need not read its header again */
+            L[k].fixed_tref = true;
+        }
+    }
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: read %d windows\n", L->file, Ctrl->C.n);
+    return y;
+}
+
+void rotate_horizontal (double *c1, const double *c2, int n, double az1, double az2, double baz, char cmp)
+{
+    /* Project two horizontal components with azimuths az1 and az2 (degree CW from north)
+     * onto the radial (cmp='R', pointing away from the source) or transverse
+     * (cmp='T', 90 degree CW from radial) direction. The result replaces c1. */
+    int i;
+    double phi = (baz + 180.0) * D2R, w1, w2;
+
+    if (cmp == 'R') {
+        w1 = cos (az1 * D2R - phi);
+        w2 = cos (az2 * D2R - phi);
+    } else {
+        w1 = sin (az1 * D2R - phi);
+        w2 = sin (az2 * D2R - phi);
+    }
+    for (i=0; i<n; i++) c1[i] = w1 * c1[i] + w2 * c2[i];
+}
+
+int load_rotated (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, SACHEAD *hd, double **y)
+{
+    /* -A: read both horizontal components of L and rotate them in memory.
+     * On success *y holds the requested component and hd its header. */
+    int i;
+    double *y2 = NULL;
+    SACHEAD hd2;
+
+    if ((*y = read_trace (GMT, Ctrl, L->file, hd, L->tref, L->win)) == NULL ||
+        (y2 = read_trace (GMT, Ctrl, L->file2, &hd2, L->tref, L->win)) == NULL) {
+        GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s,%s: Warning: unable to read, skipped.\n", L->file, L->file2);
+        if (*y) GMT_free (GMT, *y);
+        return 1;
+    }
+    set_geometry (L, hd);
+    if (fabs (hd->delta - hd2.delta) > 1.0e-4 * hd->delta || fabs (hd->b - hd2.b) > 0.5 * hd->delta) {
+        GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s,%s: Warning: components not aligned in b or delta, skipped.\n", L->file, L->file2);
+        GMT_free (GMT, *y);  GMT_free (GMT, y2);
+        return 1;
+    }
+    if (hd->baz == SAC_FLOAT_UNDEF || hd->cmpaz == SAC_FLOAT_UNDEF || hd2.cmpaz == SAC_FLOAT_UNDEF) {
+        GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s,%s: Warning: baz or cmpaz not defined in SAC header, skipped.\n", L->file, L->file2);
+        GMT_free (GMT, *y);  GMT_free (GMT, y2);
+        return 1;
+    }
+    if (hd2.npts < hd->npts) hd->npts = hd2.npts;
+
+    rotate_horizontal (*y, y2, hd->npts, hd->cmpaz, hd2.cmpaz, hd->baz, Ctrl->A.cmp);
+    GMT_free (GMT, y2);
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s,%s: rotated to %c with baz=%g\n", L->file, L->file2, Ctrl->A.cmp, hd->baz);
+
+    hd->cmpaz = (Ctrl->A.cmp == 'R') ? hd->baz + 180.0 : hd->baz + 270.0;
+    if (hd->cmpaz >= 360.0) hd->cmpaz -= 360.0;
+    hd->cmpinc = 90.0;
+    hd->e = hd->b + (hd->npts - 1) * hd->delta;
+    i = (int)strlen (hd->kcmpnm);
+    while (i > 0 && hd->kcmpnm[i-1] == ' ') i--;     /* BHN -> BHR, BHE -> BHT */
+    if (i > 0) hd->kcmpnm[i-1] = Ctrl->A.cmp;
+    return 0;
+}
+
+float *read_pyramid_trace (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, char *file, SACHEAD *hd, double tref, int win)
+{
+    /* -Z: read the coarsest pyramid level that still gives at least one point per device dot,
+     * as two points (min and max, in the order first to last) per block. hd is set up to
+     * describe these points as evenly sampled data. Return NULL to fall back to samples. */
+    int k, k0, k1, block, nblock, max_block;
+    double span, dots, per, dt;
+    float *P, *y;
+
+    if (read_sac_head (file, hd) || hd->iftype == IXY) return NULL;
+
+    /* samples per device dot along the time axis */
+    if (!GMT_IS_LINEAR(GMT)) {
+        span = Ctrl->m.sec_per_measure;
+        dots = GMT->current.setting.ps_dots_pr_inch;
+    } else if (Ctrl->v.active) {
+        span = GMT->common.R.wesn[YHI] - GMT->common.R.wesn[YLO];
+        dots = GMT->current.map.height * GMT->current.setting.ps_dots_pr_inch;
+    } else {
+        span = GMT->common.R.wesn[XHI] - GMT->common.R.wesn[XLO];
+        dots = GMT->current.map.width * GMT->current.setting.ps_dots_pr_inch;
+    }
+    per = span / dots / hd->delta;
+    max_block = (per < INT_MAX / 2) ? (int)floor (2.0 * per) : INT_MAX;
+
+    if ((P = read_sac_pyramid (file, hd, max_block, &block, &nblock)) == NULL) {
+        GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: no pyramid level of at most %d samples per block, reading samples.\n", file, max_block);
+        return NULL;
+    }
+
+    dt = block * hd->delta;
+    k0 = 0;
+    k1 = nblock;
+    if (Ctrl->C.active) {   /* blocks overlapping the -C window */
+        k0 = MAX (0, (int)floor ((tref + Ctrl->C.t0[win] - hd->b) / dt));
+        k1 = MIN (nblock, (int)ceil ((tref + Ctrl->C.t1[win] - hd->b) / dt));
+        if (k1 <= k0) {
+            free (P);
+            return NULL;
+        }
+    }
+
+    y = (float *)malloc (2 * (k1 - k0) * sizeof (float));
+    for (k = k0; k < k1; k++) {
+        float *p = &P[4*k];
+        bool falling = p[2] > p[3];
+        y[2*(k-k0)]   = falling ? p[1] : p[0];
+        y[2*(k-k0)+1] = falling ? p[0] : p[1];
+    }
+    free (P);
+
+    hd->b += k0 * dt;
+    hd->delta = (float)(0.5 * dt);
+    hd->npts = 2 * (k1 - k0);
+    hd->e = hd->b + (hd->npts - 1) * hd->delta;
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: using pyramid level of %d samples per block\n", file, block);
+    return y;
+}
+
+void build_pyramids (struct GMT_CTRL *GMT, struct SAC_LIST *L, int n_files)
+{
+    /* -Zb: write pyramid sidecars that are missing or do not match their SAC file */
+    int n;
+#ifdef _OPENMP
+#pragma omp parallel for private(n) shared(GMT,L,n_files) schedule(dynamic)
+#endif
+    for (n = 0; n < n_files; n++) {
+        SACHEAD hd;
+        int block, nblock;
+        float *P;
+        if (L[n].bad || read_sac_head (L[n].file, &hd) || hd.iftype == IXY) continue;
+        if ((P = read_sac_pyramid (L[n].file, &hd, INT_MAX, &block, &nblock)) != NULL) {
+            free (P);
+            continue;
+        }
+        GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: building pyramid\n", L[n].file);
+        if (write_sac_pyramid (L[n].file))
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: unable to build pyramid.\n", L[n].file);
+    }
+}
+
+int stat_key (char *key, const char *file)
+{
+    /* -k: append path, modification time and size of a file to key */
+    struct stat st;
+    if (stat (file, &st)) return -1;
+    sprintf (key + strlen (key), "%s %ld %ld ", file, (long)st.st_mtime, (long)st.st_size);
+    return 0;
+}
+
+int trace_cache_name (struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, char *key, char *name)
+{
+    /* -k: describe everything the samples of a trace depend on in key, and name its cache file
+     * after the FNV-1a hash of key. Return -1 if the trace cannot be cached. */
+    uint64_t hash;
+
+    key[0] = '\0';
+    if (Ctrl->l.active || Ctrl->Z.active || stat_key (key, L->file)) return -1;
+    if (L->file2) {
+        if (stat_key (key, L->file2)) return -1;
+        sprintf (key + strlen (key), "A%c", Ctrl->A.cmp);
+    }
+    if (Ctrl->C.active) sprintf (key + strlen (key), " C%.10g/%.10g", L->tref + Ctrl->C.t0[L->win], L->tref + Ctrl->C.t1[L->win]);
+    if (Ctrl->F.active && !Ctrl->S.active) sprintf (key + strlen (key), " F%s", Ctrl->F.keys);
+
+    hash = fnv1a (14695981039346656037ULL, key);
+    sprintf (name, "%s/%016llx.%s", Ctrl->k.dir, (unsigned long long)hash, (Ctrl->k.quant) ? "qtrace" : "trace");
+    return 0;
+}
+
+void quantize_trace (const double *y, int n, double *qs, int16_t *q)
+{
+    /* -k+q: samples of each block of PSSAC_QBLOCK as offset + scale * q, with q in [-32767, 32767].
+     * qs holds the offset and scale of each block. */
+    int b, i, i1;
+    double lo, hi, o, s;
+
+    for (b = 0; b * PSSAC_QBLOCK < n; b++) {
+        i1 = MIN (n, (b + 1) * PSSAC_QBLOCK);
+        lo = hi = y[b*PSSAC_QBLOCK];
+        for (i = b * PSSAC_QBLOCK; i < i1; i++) {
+            lo = MIN (lo, y[i]);
+            hi = MAX (hi, y[i]);
+        }
+        o = qs[2*b] = 0.5 * (lo + hi);
+        s = qs[2*b+1] = (hi - lo) / 65534.0;
+        for (i = b * PSSAC_QBLOCK; i < i1; i++)
+            q[i] = (s > 0.0) ? (int16_t)lrint ((y[i] - o) / s) : 0;
+    }
+}
+
+void dequantize_trace (const double *qs, const int16_t *q, int n, double *y)
+{
+    /* -k+q: samples from the offset and scale of each block, in a loop the compiler vectorizes */
+    int b, i, i1;
+
+    for (b = 0; b * PSSAC_QBLOCK < n; b++) {
+        const double o = qs[2*b], s = qs[2*b+1];
+        const int16_t *qb = q + b * PSSAC_QBLOCK;
+        double *yb = y + b * PSSAC_QBLOCK;
+        i1 = MIN (PSSAC_QBLOCK, n - b * PSSAC_QBLOCK);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+        for (i = 0; i < i1; i++) yb[i] = o + s * qb[i];
+    }
+}
+
+int read_cached_trace (struct GMT_CTRL *GMT, bool quant, char *key, char *name, struct SAC_LIST *L)
+{
+    /* -k: fill L->hd and L->data from the cache file, of 16-bit samples if quant. Return 0 on success. */
+    FILE *fp;
+    char buf[GMT_BUFSIZ];
+    int len, nblock;
+    bool ok;
+    SACHEAD hd;
+    double *y, *qs;
+    int16_t *q;
+
+    if ((fp = fopen (name, "rb")) == NULL) return -1;
+    if (fread (&len, sizeof (int), 1, fp) != 1 || len != (int)strlen (key) || len >= GMT_BUFSIZ ||
+        fread (buf, 1, len, fp) != (size_t)len || strncmp (buf, key, len) ||
+        fread (&hd, sizeof (SACHEAD), 1, fp) != 1 || hd.npts <= 0) {
+        fclose (fp);
+        return -1;
+    }
+    y = GMT_memory (GMT, NULL, hd.npts, double);
+    if (quant) {    /* offset and scale of each block, then all 16-bit samples */
+        nblock = (hd.npts + PSSAC_QBLOCK - 1) / PSSAC_QBLOCK;
+        qs = GMT_memory (GMT, NULL, 2 * nblock, double);
+        q = GMT_memory (GMT, NULL, hd.npts, int16_t);
+        ok = fread (qs, sizeof (double), 2 * nblock, fp) == (size_t)(2 * nblock) &&
+             fread (q, sizeof (int16_t), hd.npts, fp) == (size_t)hd.npts;
+        if (ok) dequantize_trace (qs, q, hd.npts, y);
+        GMT_free (GMT, qs);
+        GMT_free (GMT, q);
+    }
+    else
+        ok = fread (y, sizeof (double), hd.npts, fp) == (size_t)hd.npts;
+    fclose (fp);
+    if (!ok) {
+        GMT_free (GMT, y);
+        return -1;
+    }
+    L->hd = hd;
+    L->data = y;
+    return 0;
+}
+
+void write_cached_trace (struct GMT_CTRL *GMT, bool quant, char *key, char *name, SACHEAD *hd, double *y)
+{
+    /* -k: save a processed trace, as 16-bit samples if quant. It is written to a temporary file
+     * first, so that pssac calls running at the same time never read a partial file. */
+    FILE *fp;
+    char tmp[GMT_BUFSIZ];
+    int fd, len = (int)strlen (key), nblock = (hd->npts + PSSAC_QBLOCK - 1) / PSSAC_QBLOCK;
+    bool ok;
+    double *qs = NULL;
+    int16_t *q = NULL;
+
+    sprintf (tmp, "%s.XXXXXX", name);
+    if ((fd = mkstemp (tmp)) == -1 || (fp = fdopen (fd, "wb")) == NULL) {
+        GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Warning: unable to write cache file %s\n", name);
+        return;
+    }
+    ok = fwrite (&len, sizeof (int), 1, fp) == 1 && fwrite (key, 1, len, fp) == (size_t)len &&
+         fwrite (hd, sizeof (SACHEAD), 1, fp) == 1;
+    if (ok && quant) {
+        qs = GMT_memory (GMT, NULL, 2 * nblock, double);
+        q = GMT_memory (GMT, NULL, hd->npts, int16_t);
+        quantize_trace (y, hd->npts, qs, q);
+        ok = fwrite (qs, sizeof (double), 2 * nblock, fp) == (size_t)(2 * nblock) &&
+             fwrite (q, sizeof (int16_t), hd->npts, fp) == (size_t)hd->npts;
+        GMT_free (GMT, qs);
+        GMT_free (GMT, q);
+    }
+    else if (ok)
+        ok = fwrite (y, sizeof (double), hd->npts, fp) == (size_t)hd->npts;
+    if (fclose (fp) || !ok || rename (tmp, name)) {
+        GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Warning: unable to write cache file %s\n", name);
+        remove (tmp);
+    }
+}
+
+int plot_cache_name (struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, int n, uint64_t sig, char *key, char *name)
+{
+    /* -k+p: as trace_cache_name, for the plotted coordinates of trace n. The key adds the options,
+     * the position given in the SAC list, the -C window, and sig for scales that depend on other
+     * traces. n is added only with -En, where it places the trace, so that inserting a file into
+     * the list does not invalidate the traces after it. */
+    uint64_t hash;
+
+    key[0] = '\0';
+    name[0] = '\0';
+    if (stat_key (key, L->file) || (L->file2 && stat_key (key, L->file2))) return -1;
+    sprintf (key + strlen (key), "w%d opt%016llx sig%016llx", L->win, (unsigned long long)Ctrl->k.opt_hash, (unsigned long long)sig);
+    if (Ctrl->E.active && Ctrl->E.keys[0] == 'n' && !L->position) sprintf (key + strlen (key), " n%d", n);
+    if (L->position) sprintf (key + strlen (key), " at%.10g/%.10g", L->x, L->y);
+
+    hash = fnv1a (14695981039346656037ULL, key);
+    sprintf (name, "%s/%016llx.plot", Ctrl->k.dir, (unsigned long long)hash);
+    return 0;
+}
+
+void free_plot (struct GMT_CTRL *GMT, struct PSSAC_PLOT *P)
+{
+    GMT_free (GMT, P->x);
+    GMT_free (GMT, P->y);
+    GMT_free (GMT, P->xp);
+    GMT_free (GMT, P->yp);
+    GMT_free (GMT, P->pen);
+}
+
+int read_cached_plot (struct GMT_CTRL *GMT, char *key, char *name, struct PSSAC_PLOT *P)
+{
+    /* -k+p: fill P from the cache file. Return 0 on success. */
+    FILE *fp;
+    char buf[GMT_BUFSIZ];
+    int len;
+    bool ok;
+
+    if ((fp = fopen (name, "rb")) == NULL) return -1;
+    if (fread (&len, sizeof (int), 1, fp) != 1 || len != (int)strlen (key) || len >= GMT_BUFSIZ ||
+        fread (buf, 1, len, fp) != (size_t)len || strncmp (buf, key, len) ||
+        fread (&P->n, sizeof (int), 1, fp) != 1 || fread (&P->npts, sizeof (int), 1, fp) != 1 ||
+        fread (&P->x0, sizeof (double), 1, fp) != 1 || fread (&P->y0, sizeof (double), 1, fp) != 1 ||
+        fread (&P->yscale, sizeof (double), 1, fp) != 1 || P->n <= 0 || P->npts < 0) {
+        fclose (fp);
+        return -1;
+    }
+    P->x   = GMT_memory (GMT, NULL, P->n, double);
+    P->y   = GMT_memory (GMT, NULL, P->n, double);
+    P->xp  = GMT_memory (GMT, NULL, MAX (P->npts, 1), double);
+    P->yp  = GMT_memory (GMT, NULL, MAX (P->npts, 1), double);
+    P->pen = GMT_memory (GMT, NULL, MAX (P->npts, 1), unsigned int);
+    ok = fread (P->x, sizeof (double), P->n, fp) == (size_t)P->n && fread (P->y, sizeof (double), P->n, fp) == (size_t)P->n &&
+         fread (P->xp, sizeof (double), P->npts, fp) == (size_t)P->npts && fread (P->yp, sizeof (double), P->npts, fp) == (size_t)P->npts &&
+         fread (P->pen, sizeof (unsigned int), P->npts, fp) == (size_t)P->npts;
+    fclose (fp);
+    if (!ok) {
+        free_plot (GMT, P);
+        return -1;
+    }
+    return 0;
+}
+
+void write_cached_plot (struct GMT_CTRL *GMT, char *key, char *name, struct PSSAC_PLOT *P)
+{
+    /* -k+p: save the coordinates of a plotted trace, through a temporary file as write_cached_trace */
+    FILE *fp;
+    char tmp[GMT_BUFSIZ];
+    int fd, len = (int)strlen (key);
+    bool ok;
+
+    sprintf (tmp, "%s.XXXXXX", name);
+    if ((fd = mkstemp (tmp)) == -1 || (fp = fdopen (fd, "wb")) == NULL) {
+        GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Warning: unable to write cache file %s\n", name);
+        return;
+    }
+    ok = fwrite (&len, sizeof (int), 1, fp) == 1 && fwrite (key, 1, len, fp) == (size_t)len &&
+         fwrite (&P->n, sizeof (int), 1, fp) == 1 && fwrite (&P->npts, sizeof (int), 1, fp) == 1 &&
+         fwrite (&P->x0, sizeof (double), 1, fp) == 1 && fwrite (&P->y0, sizeof (double), 1, fp) == 1 &&
+         fwrite (&P->yscale, sizeof (double), 1, fp) == 1 &&
+         fwrite (P->x, sizeof (double), P->n, fp) == (size_t)P->n && fwrite (P->y, sizeof (double), P->n, fp) == (size_t)P->n &&
+         fwrite (P->xp, sizeof (double), P->npts, fp) == (size_t)P->npts && fwrite (P->yp, sizeof (double), P->npts, fp) == (size_t)P->npts &&
+         fwrite (P->pen, sizeof (unsigned int), P->npts, fp) == (size_t)P->npts;
+    if (fclose (fp) || !ok || rename (tmp, name)) {
+        GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Warning: unable to write cache file %s\n", name);
+        remove (tmp);
+    }
+}
+
+void draw_trace (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct PSL_CTRL *PSL, struct SAC_LIST *L, struct PSSAC_PLOT *P)
+{
+    /* Plot a scaled, shifted and projected trace, and paint it for -G */
+    int i;
+    double *x = P->x, *y = P->y;
+
+    /* plot trace */
+    if (L->custom_pen) GMT_setpen (GMT, &L->pen);
+    GMT_plot_line (GMT, P->xp, P->yp, P->pen, P->npts, L->custom_pen ? L->pen.mode : Ctrl->W.pen.mode);
+    if (L->custom_pen) GMT_setpen (GMT, &Ctrl->W.pen);
+
+    /* paint trace */
+    for (i=0; i<=1; i++) { /* 0=positive; 1=negative */
+        if (Ctrl->G.active[i]) {
+            double zero = 0.0;
+            if (!Ctrl->v.active) zero = Ctrl->G.zero[i]*P->yscale + P->y0;
+            else                 zero = Ctrl->G.zero[i]*P->yscale + P->x0;
+
+            if (!Ctrl->G.cut[i]) {
+                if (!Ctrl->v.active) {
+                    Ctrl->G.t0[i] = x[0];
+                    Ctrl->G.t1[i] = x[P->n-1];
+                } else {
+                    Ctrl->G.t0[i] = y[0];
+                    Ctrl->G.t1[i] = y[P->n-1];
+                }
+            }
+            GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: Painting traces: zero=%g t0=%g t1=%g\n",
+                    L->file, zero, Ctrl->G.t0[i], Ctrl->G.t1[i]);
+            paint_phase(GMT, Ctrl, PSL, x, y, P->npts, zero, Ctrl->G.t0[i], Ctrl->G.t1[i], i);
+        }
+    }
+}
+
+int load_sac_trace (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L)
+{
+    /* Read one SAC file, apply -F and fill L->hd, L->data and L->tref.
+     * Return 0 on success, or 1 if the trace should be skipped. */
+    int i;
+    float *data = NULL;
+    double *y = NULL;
+    SACHEAD hd;
+    char key[GMT_BUFSIZ] = {""}, cache[GMT_BUFSIZ] = {""};
+    bool cacheable = false;
+
+    if (!L->fixed_tref) {
+        /* read SAC header only to determine the reference time */
+        if (Ctrl->T.active) {
+            if (read_sac_head_cached (L->file, &hd)) {
+                GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: unable to read, skipped.\n", L->file);
+                L->bad = true;
+                return 1;
+            }
+            set_geometry (L, &hd);
+        }
+        if (sac_reference_time (GMT, Ctrl, L->file, &hd, &L->tref)) {
+            L->bad = true;
+            return 1;
+        }
+    }
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: reference time is %g\n", L->file, L->tref);
+
+    /* -k: samples may have been read and processed by an earlier pssac call */
+    if (Ctrl->k.active && !trace_cache_name (Ctrl, L, key, cache)) {
+        cacheable = true;
+        if (L->prefetched) {    /* the cache replaces the window read with the first one */
+            double *prefetch = L->data;
+            if (!read_cached_trace (GMT, Ctrl->k.quant, key, cache, L)) {
+                GMT_free (GMT, prefetch);
+                L->prefetched = false;
+                GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: read from cache %s\n", L->file, cache);
+                L->loaded = true;
+                return 0;
+            }
+            L->data = prefetch;
+        } else if (!read_cached_trace (GMT, Ctrl->k.quant, key, cache, L)) {
+            GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: read from cache %s\n", L->file, cache);
+            L->loaded = true;
+            return 0;
+        }
+    }
+
+    /* read SAC data */
+    if (L->file2) {     /* -A: a pair of horizontal components */
+        if (load_rotated (GMT, Ctrl, L, &hd, &y)) {
+            L->bad = true;
+            return 1;
+        }
+    } else if (L->resumed) {    /* -l: only the samples appended since the last run */
+        if ((data = read_sac_range (L->file, &hd, L->first_sample, INT_MAX)) == NULL) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: unable to read, skipped.\n", L->file);
+            L->bad = true;
+            return 1;
+        }
+        y = GMT_memory(GMT, 0, hd.npts, double);
+        for (i=0; i<hd.npts; i++) y[i] = data[i];
+        free (data);
+    } else if (L->prefetched) {     /* -C: read together with the first window of the file */
+        hd = L->hd;
+        y = L->data;
+        L->data = NULL;
+        L->prefetched = false;
+    } else if (Ctrl->Z.active && (data = read_pyramid_trace (GMT, Ctrl, L->file, &hd, L->tref, L->win)) != NULL) {
+        y = GMT_memory(GMT, 0, hd.npts, double);
+        for (i=0; i<hd.npts; i++) y[i] = data[i];
+        free (data);
+    } else if (Ctrl->C.n > 1 && L->win == 0 && raw_lookup (L->file) < 0) {
+        if ((y = read_windows (GMT, Ctrl, L, &hd)) == NULL) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: unable to read, skipped.\n", L->file);
+            L->bad = true;
+            return 1;
+        }
+    } else if ((y = read_trace (GMT, Ctrl, L->file, &hd, L->tref, L->win)) == NULL) {
+        GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: unable to read, skipped.\n", L->file);
+        L->bad = true;
+        return 1;
+    }
+    set_geometry (L, &hd);
+    L->npts_done = L->first_sample + hd.npts;
+
+    /* -F: data preprocess, with -S when the segment is joined to the previous one */
+    if (!Ctrl->S.active) sac_preprocess (GMT, Ctrl, y, &hd);
+
+    /* recalculate depmin, depmax, depmen for further use */
+    hd.depmax=-1.e20; hd.depmin=1.e20; hd.depmen=0.;
+    for(i=0; i<hd.npts; i++){
+        hd.depmax = hd.depmax > y[i] ? hd.depmax : y[i];
+        hd.depmin = hd.depmin < y[i] ? hd.depmin : y[i];
+        hd.depmen += y[i];
+    }
+    hd.depmen = hd.depmen/hd.npts;
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: depmax=%g depmin=%g depmen=%g\n", L->file, hd.depmax, hd.depmin, hd.depmen);
+
+    if (cacheable) write_cached_trace (GMT, Ctrl->k.quant, key, cache, &hd, y);
+
+    L->hd = hd;
+    L->data = y;
+    L->loaded = true;
+    return 0;
+}
+
+struct PSSAC_PLACE *read_order (struct GMT_CTRL *GMT, struct SAC_LIST *L, int n_files, off_t min_size, int *n_place)
+{
+    /* the entries of L that start a file, i.e. all but the second and later -C windows, in the
+     * order their files lie on disk. Files in the raw cache come first, as they need no reading.
+     * Files smaller than min_size are left out. */
+    int n;
+    struct PSSAC_PLACE *P = GMT_memory (GMT, NULL, MAX (n_files, 1), struct PSSAC_PLACE);
+
+    for (*n_place = n = 0; n < n_files; n++) {
+        if (n > 0 && L[n].win > 0) continue;
+        if (raw_lookup (L[n].file) >= 0) {
+            memset (&P[*n_place], 0, sizeof (struct PSSAC_PLACE));
+            P[(*n_place)++].n = n;
+        }
+        else if (!file_place (L[n].file, n, min_size, &P[*n_place]))
+            (*n_place)++;
+    }
+    qsort (P, *n_place, sizeof (struct PSSAC_PLACE), compare_places);
+    return P;
+}
+
+void preload_traces (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, int n_files)
+{
+    /* Load and preprocess all traces before plotting, in parallel if OpenMP is available.
+     * Files are read in the order they lie on disk; the traces are still plotted in list order.
+     * The -C windows of a file are loaded by the same thread, since the first one reads them all. */
+    int i, n, k, n_place;
+    struct PSSAC_PLACE *P = read_order (GMT, L, n_files, 0, &n_place);
+#ifdef _OPENMP
+#pragma omp parallel for private(i,n,k) shared(GMT,Ctrl,L,n_files,P,n_place) schedule(dynamic)
+#endif
+    for (i = 0; i < n_place; i++) {
+        n = P[i].n;
+        for (k = n; k < n_files && (k == n || L[k].win > 0); k++)
+            if (!L[k].loaded && !L[k].bad) load_sac_trace (GMT, Ctrl, &L[k]);
+    }
+    GMT_free (GMT, P);
+}
+
+void advise_traces (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, int n_files)
+{
+    /* Ask the kernel to read the data of the next traces in the background, in the order their
+     * files lie on disk, so that the reads in plot order find them in memory. Only the -C windows
+     * are asked for when their reference time is known without the header. Files smaller than
+     * PSSAC_READAHEAD are skipped: the kernel reads them ahead on the first read anyway. */
+    int i, n, k, n_place;
+    struct PSSAC_PLACE *P;
+
+    if (Ctrl->Z.active || Ctrl->l.active) return;   /* pyramids and appended samples only */
+    P = read_order (GMT, L, n_files, PSSAC_READAHEAD, &n_place);
+    for (i = 0; i < n_place; i++) {
+        n = P[i].n;
+        if (L[n].loaded || L[n].bad || raw_lookup (L[n].file) >= 0) continue;
+        for (k = n; k < n_files && (k == n || L[k].win > 0); k++) {
+            if (Ctrl->C.active && (!Ctrl->T.active || L[k].fixed_tref)) {
+                sac_advise (L[k].file, (float)(L[k].tref + Ctrl->C.t0[L[k].win]), (float)(L[k].tref + Ctrl->C.t1[L[k].win]));
+                if (L[k].file2) sac_advise (L[k].file2, (float)(L[k].tref + Ctrl->C.t0[L[k].win]), (float)(L[k].tref + Ctrl->C.t1[L[k].win]));
+            }
+            else if (k == n) {  /* the whole file */
+                sac_advise (L[k].file, 0.0, 0.0);
+                if (L[k].file2) sac_advise (L[k].file2, 0.0, 0.0);
+            }
+        }
+    }
+    GMT_Report (GMT->parent, GMT_MSG_LONG_VERBOSE, "Asked to read ahead %d files\n", n_place);
+    GMT_free (GMT, P);
+}
+
+int extract_window (struct SAC_LIST *L, double t0, int nwin, double *seg)
+{
+    /* copy nwin samples starting at time t0 relative to L->tref into seg, zero outside the data */
+    int j, i0 = (int)floor ((L->tref + t0 - L->hd.b) / L->hd.delta + 0.5), n_in = 0;
+
+    for (j = 0; j < nwin; j++) {
+        if (i0 + j >= 0 && i0 + j < L->hd.npts) {
+            seg[j] = L->data[i0+j];
+            n_in++;
+        } else
+            seg[j] = 0.0;
+    }
+    return n_in;
+}
+
+void align_by_xcorr (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, int n_files)
+{
+    /* -T+c: cross-correlate the window of each trace with the reference window and
+     * shift the trace by the lag of the correlation peak. The correlation is done by
+     * FFT, in parallel over traces. The reference is one trace, or the stack of all
+     * aligned traces recomputed for a few iterations.
+     * Traces are loaded PSSAC_CHUNK at a time and only their window, padded by the largest
+     * lag, is kept. The samples stay in memory if all traces fit in one chunk, otherwise
+     * the plotting loop reads them again at the aligned reference time. */
+    int n, i0, m, j, k, it, nwin = 0, npad = 0, n_good = 0, niter, ref = -1;
+    unsigned int nfft = 1;
+    double delta = 0.0, t0 = Ctrl->T.xc_t0, *rre = NULL, *rim = NULL, *lag = NULL, *cc = NULL, e_ref;
+    double **win = NULL;
+    bool *mine = NULL;
+    struct PSSAC_FFT_PLAN *P = NULL;
+
+    win = GMT_memory (GMT, NULL, n_files, double *);
+    mine = GMT_memory (GMT, NULL, n_files, bool);
+    for (i0 = 0; i0 < n_files; i0 += PSSAC_CHUNK) {
+        m = MIN (PSSAC_CHUNK, n_files - i0);
+        for (n = i0; n < i0 + m; n++) mine[n] = !L[n].loaded;
+        preload_traces (GMT, Ctrl, &L[i0], m);
+        for (n = i0; n < i0 + m; n++) {
+            if (L[n].bad || !L[n].loaded) continue;
+            if (delta == 0.0) {     /* the first good trace defines the sampling */
+                delta = L[n].hd.delta;
+                nwin = (int)((Ctrl->T.xc_t1 - t0) / delta) + 1;
+                npad = nwin;        /* lags stay within half a window of the mean lag */
+            }
+            else if (fabs (L[n].hd.delta - delta) > 1.0e-4 * delta) {
+                GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: delta differs from other traces, not aligned by -T+c.\n", L[n].file);
+                continue;
+            }
+            win[n] = GMT_memory (GMT, NULL, nwin + 2 * npad, double);
+            extract_window (&L[n], t0 - npad * delta, nwin + 2 * npad, win[n]);
+            n_good++;
+        }
+        if (n_files <= PSSAC_CHUNK) continue;
+        for (n = i0; n < i0 + m; n++) {     /* release the traces loaded here */
+            if (!mine[n] || !L[n].loaded) continue;
+            GMT_free (GMT, L[n].data);
+            L[n].data = NULL;
+            L[n].loaded = false;
+        }
+    }
+    GMT_free (GMT, mine);
+    if (Ctrl->T.xc_niter == 0) {    /* reference is a single trace */
+        ref = Ctrl->T.xc_ref;
+        if (ref < 0 || ref >= n_files || !win[ref]) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Warning: reference trace %d for -T+c is not available, no alignment.\n", ref);
+            n_good = 0;
+        }
+    }
+    while (nfft < 2U * nwin) nfft <<= 1;
+    if (n_good < 2 || (P = fft_plan (GMT, Ctrl, nfft)) == NULL) {
+        for (n = 0; n < n_files; n++) if (win[n]) GMT_free (GMT, win[n]);
+        GMT_free (GMT, win);
+        return;
+    }
+    niter = MAX (Ctrl->T.xc_niter, 1);
+
+    rre = GMT_memory (GMT, NULL, nfft, double);
+    rim = GMT_memory (GMT, NULL, nfft, double);
+    lag = GMT_memory (GMT, NULL, n_files, double);
+    cc  = GMT_memory (GMT, NULL, n_files, double);
+
+    for (it = 0; it < niter; it++) {
+        /* reference window and its spectrum */
+        memset (rre, 0, nfft * sizeof (double));
+        memset (rim, 0, nfft * sizeof (double));
+        if (ref >= 0)
+            memcpy (rre, &win[ref][npad], nwin * sizeof (double));
+        else {      /* stack of all traces with the current lags */
+            for (n = 0; n < n_files; n++) {
+                if (!win[n]) continue;
+                k = npad + (int)floor (lag[n] / delta + 0.5);
+                k = MAX (0, MIN (2 * npad, k));
+                for (j = 0; j < nwin; j++) rre[j] += win[n][k+j] / n_good;
+            }
+        }
+        for (j = 0, e_ref = 0.0; j < nwin; j++) e_ref += rre[j] * rre[j];
+        fft (P, rre, rim, false);
+
+#ifdef _OPENMP
+#pragma omp parallel for private(n,j,k) shared(GMT,Ctrl,L,n_files,P,win,npad,rre,rim,lag,cc,nwin,nfft,delta,e_ref) schedule(dynamic)
+#endif
+        for (n = 0; n < n_files; n++) {
+            double *re, *im, tr, e_x = 0.0, best, frac = 0.0, c0, c1, c2;
+            int kbest = 0, klag;
+            if (!win[n]) continue;
+            re = GMT_memory (GMT, NULL, nfft, double);
+            im = GMT_memory (GMT, NULL, nfft, double);
+            memcpy (re, &win[n][npad], nwin * sizeof (double));
+            for (j = 0; j < nwin; j++) e_x += re[j] * re[j];
+            fft (P, re, im, false);
+            for (k = 0; k < (int)nfft; k++) {   /* X * conj(R) */
+                tr    = re[k] * rre[k] + im[k] * rim[k];
+                im[k] = im[k] * rre[k] - re[k] * rim[k];
+                re[k] = tr;
+            }
+            fft (P, re, im, true);
+            /* search lags within half of the window */
+            best = -DBL_MAX;
+            for (klag = -nwin/2; klag <= nwin/2; klag++) {
+                k = (klag + nfft) % nfft;
+                if (re[k] > best) {
+                    best = re[k];
+                    kbest = klag;
+                }
+            }
+            c0 = re[(kbest - 1 + nfft) % nfft];
+            c1 = best;
+            c2 = re[(kbest + 1 + nfft) % nfft];
+            if (c0 - 2.0 * c1 + c2 < 0.0) frac = 0.5 * (c0 - c2) / (c0 - 2.0 * c1 + c2);     /* parabolic peak */
+            lag[n] = (kbest + frac) * delta;
+            cc[n] = (e_x > 0.0 && e_ref > 0.0) ? best / sqrt (e_x * e_ref) : 0.0;
+            GMT_free (GMT, re);
+            GMT_free (GMT, im);
+        }
+        if (ref < 0) {  /* keep the stack centered on the mean lag */
+            double mean = 0.0;
+            for (n = 0; n < n_files; n++)
+                if (win[n]) mean += lag[n] / n_good;
+            for (n = 0; n < n_files; n++) lag[n] -= mean;
+        }
+    }
+
+    for (n = 0; n < n_files; n++) {
+        if (!win[n]) continue;
+        L[n].tref += lag[n];
+        L[n].fixed_tref = true;     /* kept when the trace is read again */
+        GMT_free (GMT, win[n]);
+        GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: cross-correlation lag=%g cc=%.3f\n", L[n].file, lag[n], cc[n]);
+    }
+    GMT_free (GMT, rre);
+    GMT_free (GMT, rim);
+    GMT_free (GMT, lag);
+    GMT_free (GMT, cc);
+    GMT_free (GMT, win);
+}
+
+double global_yscale (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, int n_files)
+{
+    /* Prepass for -M<size>/g|m|p.
+     * The amplitude range (depmax-depmin) of each trace is collected into a table.
+     * depmin/depmax from the header are used when they describe the plotted data,
+     * i.e. no -A rotation, no -C window and no -F processing. Otherwise the traces are loaded in
+     * parallel, PSSAC_CHUNK at a time. They are kept in memory if they all fit in one chunk, so that
+     * the plotting loop does not read them again; longer lists are read twice to bound the memory.
+     */
+    int n, k, i0, m, n_amp = 0;
+    double *amp = NULL, stat = 0.0, pos;
+    bool trust_head = !Ctrl->A.active && !Ctrl->C.active && Ctrl->F.keys[0] == '\0';
+    bool *mine = NULL;
+
+    amp = GMT_memory (GMT, NULL, n_files, double);
+    mine = GMT_memory (GMT, NULL, n_files, bool);
+
+    for (i0 = 0; i0 < n_files; i0 += PSSAC_CHUNK) {
+        m = MIN (PSSAC_CHUNK, n_files - i0);
+#ifdef _OPENMP
+#pragma omp parallel for private(n) shared(GMT,Ctrl,L,i0,m,amp,mine,trust_head)
+#endif
+        for (n = i0; n < i0 + m; n++) {
+            SACHEAD hd;
+            amp[n] = -1.0;
+            if (trust_head && !read_sac_head_cached (L[n].file, &hd) &&
+                hd.depmin != SAC_FLOAT_UNDEF && hd.depmax != SAC_FLOAT_UNDEF && hd.depmax > hd.depmin)
+                amp[n] = hd.depmax - hd.depmin;
+            else if (L[n].loaded)
+                amp[n] = L[n].hd.depmax - L[n].hd.depmin;
+            else if (!load_sac_trace (GMT, Ctrl, &L[n])) {
+                mine[n] = true;
+                amp[n] = L[n].hd.depmax - L[n].hd.depmin;
+            }
+        }
+        if (n_files <= PSSAC_CHUNK) continue;
+        for (n = i0; n < i0 + m; n++) {     /* release the traces loaded here */
+            if (!mine[n]) continue;
+            GMT_free (GMT, L[n].data);
+            L[n].data = NULL;
+            L[n].loaded = false;
+        }
+    }
+    GMT_free (GMT, mine);
+
+    for (n = 0; n < n_files; n++)   /* compact the table, dropping unreadable traces */
+        if (amp[n] > 0.0) amp[n_amp++] = amp[n];
+
+    if (n_amp > 0) {
+        GMT_sort_array (GMT, amp, n_amp, GMT_DOUBLE);
+        switch (Ctrl->M.global) {
+            case PSSAC_GLOBAL_MAX:
+                stat = amp[n_amp-1];
+                break;
+            case PSSAC_GLOBAL_MEDIAN:
+                k = n_amp / 2;
+                stat = (n_amp % 2) ? amp[k] : 0.5 * (amp[k-1] + amp[k]);
+                break;
+            case PSSAC_GLOBAL_PERCENTILE:
+                pos = 0.01 * Ctrl->M.percent * (n_amp - 1);
+                k = (int)floor (pos);
+                stat = (k + 1 < n_amp) ? amp[k] + (pos - k) * (amp[k+1] - amp[k]) : amp[n_amp-1];
+                break;
+        }
+        GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Global amplitude of %d traces: %g\n", n_amp, stat);
+    }
+    GMT_free (GMT, amp);
+
+    return (stat > 0.0) ? Ctrl->M.size / stat : 0.0;
+}
+
+bool same_channel (SACHEAD *h1, SACHEAD *h2)
+{
+    /* true if two headers belong to the same station and channel, ignoring the orientation code */
+    int n1 = (int)strlen (h1->kcmpnm), n2 = (int)strlen (h2->kcmpnm);
+
+    while (n1 > 0 && h1->kcmpnm[n1-1] == ' ') n1--;
+    while (n2 > 0 && h2->kcmpnm[n2-1] == ' ') n2--;
+    return (strcmp (h1->knetwk, h2->knetwk) == 0 && strcmp (h1->kstnm, h2->kstnm) == 0 &&
+            strcmp (h1->khole, h2->khole) == 0 && n1 == n2 && strncmp (h1->kcmpnm, h2->kcmpnm, MAX (n1-1, 0)) == 0);
+}
+
+int pair_components (struct GMT_CTRL *GMT, struct SAC_LIST *L, int n_files)
+{
+    /* -A: match the horizontal components of each station by their headers.
+     * Entries given as <file1>,<file2> are kept as they are.
+     * Unpaired files are dropped. Return the new number of entries. */
+    int n, m, k = 0;
+    double d;
+    SACHEAD *hd = GMT_memory (GMT, NULL, n_files, SACHEAD);
+    bool *horizontal = GMT_memory (GMT, NULL, n_files, bool);
+
+    for (n = 0; n < n_files; n++) {
+        horizontal[n] = false;
+        if (L[n].file2 || read_sac_head_cached (L[n].file, &hd[n])) continue;
+        horizontal[n] = (hd[n].cmpaz != SAC_FLOAT_UNDEF && (hd[n].cmpinc == SAC_FLOAT_UNDEF || fabs (hd[n].cmpinc - 90.0) < 1.0));
+    }
+    for (n = 0; n < n_files; n++) {
+        if (!horizontal[n]) continue;
+        for (m = n + 1; m < n_files; m++) {
+            if (!horizontal[m] || !same_channel (&hd[n], &hd[m])) continue;
+            d = fmod (hd[m].cmpaz - hd[n].cmpaz + 720.0, 180.0);
+            if (fabs (d - 90.0) > 1.0) continue;    /* not orthogonal */
+            L[n].file2 = L[m].file;
+            L[m].file = NULL;
+            horizontal[n] = horizontal[m] = false;
+            GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s,%s: paired for rotation\n", L[n].file, L[n].file2);
+            break;
+        }
+    }
+    for (n = 0; n < n_files; n++) {     /* keep the pairs only */
+        if (L[n].file && L[n].file2)
+            L[k++] = L[n];
+        else if (L[n].file) {
+            GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: Warning: no matching horizontal component, skipped.\n", L[n].file);
+            free (L[n].file);
+        }
+    }
+    GMT_free (GMT, hd);
+    GMT_free (GMT, horizontal);
+    return k;
+}
+
+void split_pair (struct SAC_LIST *L)
+{
+    /* <file1>,<file2> gives a pair of horizontal components for -A */
+    char *c;
+    if ((c = strchr (L->file, ',')) == NULL) return;
+    *c = '\0';
+    L->file2 = strdup (c+1);
+}
+
+int expand_windows (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST **list, int n_files)
+{
+    /* -C given more than once: one entry per file and window, the windows of a file next to each
+     * other so that load_sac_trace can read them together. Return the new number of entries. */
+    int n, k, m = 0;
+    struct SAC_LIST *L = *list, *W = GMT_memory (GMT, NULL, n_files * Ctrl->C.n, struct SAC_LIST);
+
+    for (n = 0; n < n_files; n++) {
+        for (k = 0; k < Ctrl->C.n; k++, m++) {
+            W[m] = L[n];
+            W[m].win = k;
+            if (k == 0) continue;
+            W[m].file = strdup (L[n].file);
+            if (L[n].file2) W[m].file2 = strdup (L[n].file2);
+        }
+    }
+    GMT_free (GMT, L);
+    *list = W;
+    return m;
+}
+
+int compare_segments (const void *p1, const void *p2)
+{
+    const struct PSSAC_SEGMENT *a = p1, *b = p2;
+    int c = strcmp (a->key, b->key);
+    if (c) return c;
+    if (a->start < b->start) return -1;
+    if (a->start > b->start) return 1;
+    return a->n - b->n;
+}
+
+int join_segment (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, struct PSSAC_JOIN *J)
+{
+    /* -S: continue the stitched trace with the loaded segment L. Samples overlapping the previous
+     * segment are dropped, then -F is run on the rest with the filter state left by the previous
+     * segment, or from rest at the first segment of a trace and after a gap. Without a gap the
+     * last sample of the previous segment is put in front, so that the lines join.
+     * Return 1 if the segment is covered by the previous one, and free it. */
+    int i, skip = 0;
+    unsigned int k;
+    bool joined = false;
+    double t0 = L->hd.b - L->tref;
+    SACHEAD *hd = &L->hd;
+    struct PSSAC_FILTER *F = NULL;
+
+    if (L->trace == J->trace) {
+        if (t0 < J->end + 0.5*hd->delta) skip = (int)floor((J->end - t0)/hd->delta + 0.5) + 1;
+        if (skip >= hd->npts) {
+            GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: covered by previous segment, skipped.\n", L->file);
+            GMT_free (GMT, L->data);
+            L->data = NULL;
+            L->loaded = false;
+            return 1;
+        }
+        if (skip > 0) {
+            memmove (L->data, L->data+skip, (hd->npts-skip)*sizeof(double));
+            hd->npts -= skip;
+            hd->b += skip*hd->delta;
+            t0 += skip*hd->delta;
+        }
+        if (!(joined = (t0 - J->end < 1.5*hd->delta)))
+            GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: gap of %g s before segment\n", L->file, t0 - J->end);
+    }
+    if (!joined) memset (J->z, 0, sizeof (J->z));
+
+    for (k = 0; k < Ctrl->F.n_ops; k++) {  /* only q and one-pass b are allowed with -S */
+        F = &Ctrl->F.op[k];
+        if (F->type == 'q') sqr (L->data, hd->npts);
+        else if (F->type == 'b') bandpass (L->data, hd->npts, hd->delta, F->arg[0], F->arg[1], (unsigned int)F->arg[2], 1, J->z[k]);
+    }
+    if (Ctrl->F.n_ops) {
+        hd->depmax = -1.e20; hd->depmin = 1.e20; hd->depmen = 0.;
+        for (i = 0; i < hd->npts; i++) {
+            hd->depmax = MAX (hd->depmax, L->data[i]);
+            hd->depmin = MIN (hd->depmin, L->data[i]);
+            hd->depmen += L->data[i];
+        }
+        hd->depmen /= hd->npts;
+    }
+
+    if (joined) {
+        L->data = GMT_memory (GMT, L->data, hd->npts+1, double);
+        memmove (L->data+1, L->data, hd->npts*sizeof(double));
+        L->data[0] = J->last;
+        hd->npts++;
+        hd->b = J->end + L->tref;
+    }
+    J->trace = L->trace;
+    J->end = hd->b - L->tref + (hd->npts-1)*hd->delta;
+    J->last = L->data[hd->npts-1];
+    return 0;
+}
+
+int stitch_segments (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, int n_files)
+{
+    /* Prepass for -S.
+     * Sort the SAC list by channel and absolute begin time, and number the stitched traces.
+     * All segments of a trace share the reference time of its first segment, shifted by the
+     * difference of their absolute reference times, and share one amplitude range for -M.
+     * Only headers are read here, unless -F changes the amplitudes that -M normalizes by;
+     * then each segment is loaded, joined to the previous one as in the plotting loop, measured
+     * and freed again, so that only one segment is in memory at a time, and the plotting loop
+     * reads it a second time. Return the number of stitched traces.
+     */
+    int n, k, first = 0, n_trace = 0;
+    bool norm = Ctrl->M.active && (Ctrl->M.norm || Ctrl->M.scaleALL);  /* the amplitude range is used */
+    double ep0 = 0.0, tref0 = 0.0, dmin = 0.0, dmax = 0.0;
+    SACHEAD *hd = GMT_memory (GMT, NULL, n_files, SACHEAD);
+    double *epoch = GMT_memory (GMT, NULL, n_files, double);
+    struct PSSAC_SEGMENT *S = GMT_memory (GMT, NULL, n_files, struct PSSAC_SEGMENT);
+    struct SAC_LIST *L0 = GMT_memory (GMT, NULL, n_files, struct SAC_LIST);
+    struct PSSAC_JOIN *J = GMT_memory (GMT, NULL, 1, struct PSSAC_JOIN);
+
+    J->trace = -1;
+
+#ifdef _OPENMP
+#pragma omp parallel for private(n) shared(GMT,L,n_files,hd,epoch,S)
+#endif
+    for (n = 0; n < n_files; n++) {
+        S[n].n = n;
+        S[n].start = 0.0;
+        S[n].key[0] = '\0';
+        if (L[n].bad) continue;
+        if (read_sac_head_cached (L[n].file, &hd[n])) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: unable to read, skipped.\n", L[n].file);
+            L[n].bad = true;
+        } else if (sac_epoch (&hd[n], &epoch[n])) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: reference time not defined in SAC header, skipped.\n", L[n].file);
+            L[n].bad = true;
+        } else {
+            set_geometry (&L[n], &hd[n]);
+            sprintf (S[n].key, "%s.%s.%s.%s", hd[n].knetwk, hd[n].kstnm, hd[n].khole, hd[n].kcmpnm);
+            S[n].start = epoch[n] + hd[n].b;
+        }
+    }
+    qsort (S, n_files, sizeof (struct PSSAC_SEGMENT), compare_segments);
+
+    /* reorder the list; the list structs are moved, not copied deeply */
+    memcpy (L0, L, n_files * sizeof (struct SAC_LIST));
+    for (k = 0; k < n_files; k++) {
+        n = S[k].n;
+        L[k] = L0[n];
+        if (L[k].bad) continue;
+        if (n_trace == 0 || strcmp (S[k].key, S[first].key)) {     /* first segment of a new trace */
+            if (n_trace) for (n = first; n < k; n++) L[n].amp = dmax - dmin;
+            if (sac_reference_time (GMT, Ctrl, L[k].file, &hd[S[k].n], &tref0)) {
+                L[k].bad = true;
+                continue;
+            }
+            first = k;
+            ep0 = epoch[S[k].n];
+            dmin = DBL_MAX;
+            dmax = -DBL_MAX;
+            n_trace++;
+            GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Stitched trace %d: %s\n", n_trace - 1, S[k].key);
+        }
+        L[k].trace = n_trace - 1;
+        L[k].tref = tref0 - (epoch[S[k].n] - ep0);
+        L[k].fixed_tref = true;
+
+        if (Ctrl->F.active) {   /* amplitudes change, measure them on the loaded segment */
+            if (!norm || load_sac_trace (GMT, Ctrl, &L[k]) || join_segment (GMT, Ctrl, &L[k], J)) continue;
+            dmin = MIN (dmin, L[k].hd.depmin);
+            dmax = MAX (dmax, L[k].hd.depmax);
+            GMT_free (GMT, L[k].data);
+            L[k].data = NULL;
+            L[k].loaded = false;
+        } else {
+            dmin = MIN (dmin, hd[S[k].n].depmin);
+            dmax = MAX (dmax, hd[S[k].n].depmax);
+        }
+    }
+    if (n_trace) for (n = first; n < n_files; n++) L[n].amp = dmax - dmin;
+
+    GMT_free (GMT, hd);
+    GMT_free (GMT, epoch);
+    GMT_free (GMT, S);
+    GMT_free (GMT, L0);
+    GMT_free (GMT, J);
+    return n_trace;
+}
+
+int decimate_minmax (const double *y, int n, double delta, int per, double *xo, double *yo)
+{
+    /* Reduce n samples to the minimum and maximum of every <per> samples, kept in time order.
+     * x of the output is relative to the first sample. Return the number of output points. */
+    int i, k, m = 0;
+
+    if (per < 3) {  /* nothing to gain */
+        for (i = 0; i < n; i++) {
+            xo[i] = i * delta;
+            yo[i] = y[i];
+        }
+        return n;
+    }
+    for (i = 0; i < n; i += per) {
+        int e = MIN (i + per, n), imin = i, imax = i, i1, i2;
+        for (k = i + 1; k < e; k++) {
+            if (y[k] < y[imin]) imin = k;
+            if (y[k] > y[imax]) imax = k;
+        }
+        i1 = MIN (imin, imax);
+        i2 = MAX (imin, imax);
+        xo[m] = i1 * delta;  yo[m++] = y[i1];
+        if (i2 != i1) {
+            xo[m] = i2 * delta;  yo[m++] = y[i2];
+        }
+    }
+    return m;
+}
+
+void plot_helicorder (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, double *y, SACHEAD *hd, double t0, unsigned int mode)
+{
+    /* -L: plot a trace beginning at time t0 as helicorder rows. Row r covers [r*length, (r+1)*length)
+     * and is plotted from x=0 at y=r. Each row is reduced to the min/max of every device dot. */
+    int r, r0, r1, i0, i1, m, k, per, n_max;
+    double len = Ctrl->L.length, bin, *xo, *yo;
+
+    /* time spanned by one device dot along the x-axis */
+    bin = (GMT->common.R.wesn[XHI] - GMT->common.R.wesn[XLO]) / (GMT->current.map.width * GMT->current.setting.ps_dots_pr_inch);
+    per = (int)floor (bin / hd->delta);
+
+    r0 = (int)floor (t0 / len);
+    r1 = (int)floor ((t0 + (hd->npts - 1) * hd->delta) / len);
+    n_max = MIN (hd->npts, (int)ceil (len / hd->delta) + 2);
+    xo = GMT_memory (GMT, NULL, n_max, double);
+    yo = GMT_memory (GMT, NULL, n_max, double);
+
+    for (r = r0; r <= r1; r++) {
+        i0 = MAX (0, (int)ceil ((r * len - t0) / hd->delta - 1.0e-6));
+        i1 = MIN (hd->npts, (int)ceil (((r + 1) * len - t0) / hd->delta - 1.0e-6));
+        if (i1 <= i0) continue;
+        m = decimate_minmax (&y[i0], i1 - i0, hd->delta, per, xo, yo);
+        for (k = 0; k < m; k++) {
+            xo[k] += t0 + i0 * hd->delta - r * len;
+            yo[k] += r;
+        }
+        GMT->current.plot.n = GMT_geo_to_xy_line (GMT, xo, yo, m);
+        GMT_plot_line (GMT, GMT->current.plot.x, GMT->current.plot.y, GMT->current.plot.pen, GMT->current.plot.n, mode);
+    }
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Plotted %d helicorder rows, %d samples per point\n", r1 - r0 + 1, MAX (per, 1));
+
+    GMT_free (GMT, xo);
+    GMT_free (GMT, yo);
+}
+
+double live_begin (SACHEAD *hd)
+{
+    /* -l: absolute time of the first sample, or b if the reference time is undefined */
+    double epoch;
+    return sac_epoch (hd, &epoch) ? hd->b : epoch + hd->b;
+}
+
+void read_live_state (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, int n_files)
+{
+    /* -l: find the samples consumed and the scale factor of each file in the last run.
+     * Files that grew are read from their last plotted sample on; files that did not are skipped.
+     * A file that got shorter or begins at another time has been rewritten and is plotted whole. */
+    FILE *fp;
+    char line[GMT_BUFSIZ] = {""}, file[GMT_BUFSIZ] = {""};
+    int n, npts, n_col, n_resumed = 0;
+    double yscale, begin;
+    SACHEAD hd;
+
+    if ((fp = fopen (Ctrl->l.file, "r")) == NULL) {
+        GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "No state in %s, plotting whole traces.\n", Ctrl->l.file);
+        return;
+    }
+    while (fgets (line, GMT_BUFSIZ, fp)) {
+        if (line[0] == '#' || (n_col = sscanf (line, "%s %d %lf %lf", file, &npts, &yscale, &begin)) < 3 || npts <= 0) continue;
+        for (n = 0; n < n_files; n++) {
+            if (strcmp (file, L[n].file) || read_sac_head (L[n].file, &hd)) continue;
+            if (hd.npts < npts) {   /* rewritten since the last run, start over */
+                GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: shorter than in the last run, plotting whole trace.\n", L[n].file);
+                continue;
+            }
+            if (n_col == 4 && fabs (live_begin (&hd) - begin) > 0.5 * hd.delta) {
+                GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: begins at another time than in the last run, plotting whole trace.\n", L[n].file);
+                continue;
+            }
+            L[n].resumed = true;
+            L[n].first_sample = npts - 1;   /* start from the last plotted sample to join the line */
+            L[n].npts_done = npts;
+            L[n].yscale = yscale;
+            if (hd.npts == npts) {
+                GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "=> %s: no new samples, skipped.\n", L[n].file);
+                L[n].bad = true;
+            } else
+                n_resumed++;
+        }
+    }
+    fclose (fp);
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Continuing %d traces from %s.\n", n_resumed, Ctrl->l.file);
+}
+
+void write_live_state (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, int n_files)
+{
+    /* -l: save samples consumed and scale factor of each file. The state file is replaced
+     * atomically, so that a display reading it never sees it half written. */
+    FILE *fp;
+    char tmp[GMT_LEN256+8];
+    int n;
+    SACHEAD hd;
+
+    sprintf (tmp, "%s.tmp", Ctrl->l.file);
+    if ((fp = fopen (tmp, "w")) == NULL) {
+        GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Warning: unable to write state file %s\n", tmp);
+        return;
+    }
+    fprintf (fp, "# pssac -l state: file npts yscale begin\n");
+    for (n = 0; n < n_files; n++)
+        if (L[n].npts_done > 0 && !read_sac_head (L[n].file, &hd))
+            fprintf (fp, "%s %d %.15g %.15g\n", L[n].file, L[n].npts_done, L[n].yscale, live_begin (&hd));
+    fclose (fp);
+    if (rename (tmp, Ctrl->l.file))
+        GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Warning: unable to replace state file %s\n", Ctrl->l.file);
+}
+
+float *coordinate_field (struct PSSAC_CTRL *Ctrl, SACHEAD *hd)
+{
+    /* -N: the header field used as -E coordinate */
+    switch (Ctrl->E.keys[0]) {
+        case 'a': return &hd->az;
+        case 'b': return &hd->baz;
+        case 'd': return &hd->gcarc;
+        case 'k': return &hd->dist;
+        case 'u': return (float *)hd + USERN + ((Ctrl->E.keys[1] != '\0') ? atoi (&Ctrl->E.keys[1]) : 0);
+    }
+    return NULL;
+}
+
+void instantaneous_phase (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, double *y, int npts, double *c, double *s)
+{
+    /* cosine and sine of the instantaneous phase of y, from its analytic signal */
+    unsigned int n = 1, k;
+    double *re, *im, a;
+    struct PSSAC_FFT_PLAN *P = NULL;
+
+    while (n < (unsigned int)npts) n <<= 1;
+    if ((P = fft_plan (GMT, Ctrl, n)) == NULL) {   /* no phase information, weight 1 */
+        for (k = 0; k < (unsigned int)npts; k++) c[k] = 1.0, s[k] = 0.0;
+        return;
+    }
+    re = GMT_memory (GMT, NULL, n, double);
+    im = GMT_memory (GMT, NULL, n, double);
+    memcpy (re, y, npts * sizeof (double));
+    fft (P, re, im, false);
+    for (k = 1; k < n/2; k++) {
+        re[k] *= 2.0;  im[k] *= 2.0;
+        re[n-k] = im[n-k] = 0.0;
+    }
+    fft (P, re, im, true);
+    for (k = 0; k < (unsigned int)npts; k++) {
+        a = hypot (re[k], im[k]);
+        c[k] = (a > 0.0) ? re[k] / a : 0.0;
+        s[k] = (a > 0.0) ? im[k] / a : 0.0;
+    }
+    GMT_free (GMT, re);
+    GMT_free (GMT, im);
+}
+
+int stack_bin (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST *L, int *member, int n_member, double center, struct SAC_LIST *S)
+{
+    /* -N: stack the traces L[member[]] on a common time axis into S. Only this bin is held in memory. */
+    int m, i, j, n, n_ok = 0;
+    double t0 = DBL_MAX, t1 = -DBL_MAX, delta = 0.0, t, w, v, r;
+    double *sum = NULL, *cnt = NULL, *cs = NULL, *sn = NULL, *pc = NULL, *ps = NULL, *y;
+    SACHEAD hd;
+
+    for (m = 0; m < n_member; m++) {
+        struct SAC_LIST *T = &L[member[m]];
+        if (!T->loaded && load_sac_trace (GMT, Ctrl, T)) continue;
+        if (n_ok++ == 0) {
+            delta = T->hd.delta;
+            hd = T->hd;
+        }
+        t0 = MIN (t0, T->hd.b - T->tref);
+        t1 = MAX (t1, T->hd.b - T->tref + (T->hd.npts - 1) * T->hd.delta);
+    }
+    if (n_ok == 0) return 1;
+
+    n = (int)floor ((t1 - t0) / delta + 0.5) + 1;
+    sum = GMT_memory (GMT, NULL, n, double);
+    cnt = GMT_memory (GMT, NULL, n, double);
+    if (Ctrl->N.mode == 'p') {
+        cs = GMT_memory (GMT, NULL, n, double);
+        sn = GMT_memory (GMT, NULL, n, double);
+    }
+
+    for (m = 0; m < n_member; m++) {
+        struct SAC_LIST *T = &L[member[m]];
+        if (!T->loaded) continue;
+        if (Ctrl->N.mode == 'p') {
+            pc = GMT_memory (GMT, NULL, T->hd.npts, double);
+            ps = GMT_memory (GMT, NULL, T->hd.npts, double);
+            instantaneous_phase (GMT, Ctrl, T->data, T->hd.npts, pc, ps);
+        }
+        for (i = 0; i < n; i++) {  /* linear interpolation onto the common time axis */
+            t = (t0 + i * delta - (T->hd.b - T->tref)) / T->hd.delta;
+            j = (int)floor (t);
+            if (j < 0 || j > T->hd.npts - 1 || (j == T->hd.npts - 1 && t > j)) continue;
+            w = (j < T->hd.npts - 1) ? t - j : 0.0;
+            v = (1.0 - w) * T->data[j] + ((w > 0.0) ? w * T->data[j+1] : 0.0);
+            if (Ctrl->N.mode == 'n') v = copysign (pow (fabs (v), 1.0 / Ctrl->N.order), v);
+            sum[i] += v;
+            cnt[i] += 1.0;
+            if (Ctrl->N.mode == 'p') {
+                cs[i] += pc[j];
+                sn[i] += ps[j];
+            }
+        }
+        if (Ctrl->N.mode == 'p') {
+            GMT_free (GMT, pc);
+            GMT_free (GMT, ps);
+        }
+        GMT_free (GMT, T->data);
+        T->data = NULL;
+        T->loaded = false;
+    }
+
+    y = sum;    /* the stack replaces the sum in place */
+    for (i = 0; i < n; i++) {
+        if (cnt[i] == 0.0) continue;
+        r = sum[i] / cnt[i];
+        switch (Ctrl->N.mode) {
+            case 'n':
+                y[i] = copysign (pow (fabs (r), Ctrl->N.order), r);
+                break;
+            case 'p':
+                y[i] = r * pow (hypot (cs[i], sn[i]) / cnt[i], Ctrl->N.order);
+                break;
+            default:
+                y[i] = r;
+                break;
+        }
+    }
+    GMT_free (GMT, cnt);
+    if (Ctrl->N.mode == 'p') {
+        GMT_free (GMT, cs);
+        GMT_free (GMT, sn);
+    }
+
+    hd.b = (float)t0;
+    hd.delta = (float)delta;
+    hd.npts = n;
+    hd.e = (float)(t0 + (n - 1) * delta);
+    *coordinate_field (Ctrl, &hd) = (float)center;
+    hd.depmax = -1.e20; hd.depmin = 1.e20; hd.depmen = 0.;
+    for (i = 0; i < n; i++) {
+        hd.depmax = MAX (hd.depmax, y[i]);
+        hd.depmin = MIN (hd.depmin, y[i]);
+        hd.depmen += y[i];
+    }
+    hd.depmen /= n;
+
+    S->file = malloc (GMT_LEN64);
+    snprintf (S->file, GMT_LEN64, "stack of %d traces at %g", n_ok, center);
+    S->hd = hd;
+    S->data = y;
+    S->tref = 0.0;
+    S->fixed_tref = true;
+    S->loaded = true;
+    return 0;
+}
+
+struct PSSAC_BIN {  /* -N: bin of one trace */
+    int bin;
+    int n;
+};
+
+int compare_bins (const void *p1, const void *p2)
+{
+    const struct PSSAC_BIN *a = p1, *b = p2;
+    if (a->bin != b->bin) return (a->bin < b->bin) ? -1 : 1;
+    return a->n - b->n;
+}
+
+int stack_traces (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct SAC_LIST **list, int n_files)
+{
+    /* -N: replace the SAC list by one stacked trace per bin of the -E coordinate.
+     * Bins are stacked in parallel. Return the number of stacked traces. */
+    int n, k, n_bin = 0, n_ok = 0, first;
+    struct SAC_LIST *L = *list, *S = NULL;
+    struct PSSAC_BIN *B = GMT_memory (GMT, NULL, n_files, struct PSSAC_BIN);
+    int *member = GMT_memory (GMT, NULL, n_files, int), *start = NULL, *ok = NULL;
+
+#ifdef _OPENMP
+#pragma omp parallel for private(n) shared(GMT,Ctrl,L,n_files,B)
+#endif
+    for (n = 0; n < n_files; n++) {
+        SACHEAD hd;
+        float v;
+        B[n].n = n;
+        B[n].bin = INT_MAX;
+        if (L[n].bad) continue;
+        if (L[n].loaded)
+            hd = L[n].hd;
+        else if (read_sac_head_cached (L[n].file, &hd)) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: unable to read, skipped.\n", L[n].file);
+            continue;
+        }
+        set_geometry (&L[n], &hd);
+        if ((v = *coordinate_field (Ctrl, &hd)) == SAC_FLOAT_UNDEF) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "=> %s: Warning: -E coordinate not defined in SAC header, skipped.\n", L[n].file);
+            continue;
+        }
+        B[n].bin = (int)floor (v / Ctrl->N.bin);
+    }
+    qsort (B, n_files, sizeof (struct PSSAC_BIN), compare_bins);
+
+    /* members of each bin are contiguous after sorting */
+    start = GMT_memory (GMT, NULL, n_files + 1, int);
+    for (n = 0; n < n_files && B[n].bin != INT_MAX; n++) {
+        if (n == 0 || B[n].bin != B[n-1].bin) start[n_bin++] = n;
+        member[n] = B[n].n;
+    }
+    start[n_bin] = n;
+
+    S = GMT_memory (GMT, NULL, MAX (n_bin, 1), struct SAC_LIST);
+    ok = GMT_memory (GMT, NULL, MAX (n_bin, 1), int);
+#ifdef _OPENMP
+#pragma omp parallel for private(k) shared(GMT,Ctrl,L,B,member,start,n_bin,S,ok) schedule(dynamic)
+#endif
+    for (k = 0; k < n_bin; k++)
+        ok[k] = !stack_bin (GMT, Ctrl, L, &member[start[k]], start[k+1] - start[k], (B[start[k]].bin + 0.5) * Ctrl->N.bin, &S[k]);
+
+    for (k = 0; k < n_bin; k++) {   /* drop empty bins */
+        if (!ok[k]) continue;
+        first = member[start[k]];
+        S[k].custom_pen = L[first].custom_pen;
+        S[k].pen = L[first].pen;
+        S[n_ok++] = S[k];
+    }
+    for (n = 0; n < n_files; n++) {
+        free (L[n].file);
+        if (L[n].file2) free (L[n].file2);
+        if (L[n].loaded) GMT_free (GMT, L[n].data);
+    }
+    GMT_free (GMT, L);
+    GMT_free (GMT, B);
+    GMT_free (GMT, member);
+    GMT_free (GMT, start);
+    GMT_free (GMT, ok);
+
+    *list = S;
+    return n_ok;
+}
+
+void raster_trace (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct PSSAC_RASTER *R, struct PSSAC_PLOT *P)
+{
+    /* -I: add the line of a projected trace, and its -G fill coverage, to the density raster.
+     * Line segments are walked one pixel at a time, in parallel. Fills are counted once per
+     * pixel column (row for -v), from the zero line to the extreme of the trace in it. */
+    int i, k, nx = R->nx, ny = R->ny;
+    double dpi = Ctrl->I.dpi;
+    bool vert = Ctrl->v.active;
+
+#ifdef _OPENMP
+#pragma omp parallel for private(i) shared(P,R,nx,ny,dpi) schedule(static)
+#endif
+    for (i = 1; i < P->npts; i++) {
+        int s, steps, ix, iy, ix0 = -1, iy0 = -1;
+        double x0 = P->xp[i-1] * dpi, y0 = P->yp[i-1] * dpi, dx, dy;
+        if (P->pen[i] == PSL_MOVE) continue;
+        dx = P->xp[i] * dpi - x0;
+        dy = P->yp[i] * dpi - y0;
+        steps = (int)ceil (MAX (fabs (dx), fabs (dy))) + 1;
+        for (s = 0; s < steps; s++) {
+            ix = (int)floor (x0 + dx * s / steps);
+            iy = (int)floor (y0 + dy * s / steps);
+            if ((ix == ix0 && iy == iy0) || ix < 0 || ix >= nx || iy < 0 || iy >= ny) continue;
+            ix0 = ix;  iy0 = iy;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+            R->line[(size_t)(ny - 1 - iy) * nx + ix]++;
+        }
+    }
+
+    for (k = 0; k <= 1; k++) {  /* 0=positive; 1=negative */
+        int nu = vert ? ny : nx, nw = vert ? nx : ny, u, w, w0, w1, zero_w;
+        double zx, zy, zero, *ext;
+        if (!Ctrl->G.active[k]) continue;
+
+        /* zero line in pixels across the trace */
+        zero = Ctrl->G.zero[k] * P->yscale + (vert ? P->x0 : P->y0);
+        if (GMT_IS_LINEAR(GMT))
+            GMT_geo_to_xy (GMT, vert ? zero : P->x[0], vert ? P->y[0] : zero, &zx, &zy);
+        else
+            zx = zy = zero;
+        zero_w = (int)floor ((vert ? zx : zy) * dpi);
+
+        /* extreme of the trace in each column, beyond the zero line */
+        ext = GMT_memory (GMT, NULL, nu, double);
+        for (u = 0; u < nu; u++) ext[u] = zero_w;
+        for (i = 0; i < P->npts; i++) {   /* each sample, and the columns up to the previous one */
+            double u1 = (vert ? P->yp[i] : P->xp[i]) * dpi, w1d = (vert ? P->xp[i] : P->yp[i]) * dpi;
+            double u0 = u1, w0d = w1d;
+            if (i > 0 && P->pen[i] != PSL_MOVE) {
+                u0 = (vert ? P->yp[i-1] : P->xp[i-1]) * dpi;
+                w0d = (vert ? P->xp[i-1] : P->yp[i-1]) * dpi;
+            }
+            for (u = MAX (0, (int)floor (MIN (u0, u1))); u <= MIN (nu - 1, (int)floor (MAX (u0, u1))); u++) {
+                double f = (u1 == u0) ? 1.0 : MAX (0.0, MIN (1.0, (u + 0.5 - u0) / (u1 - u0)));
+                w = (int)floor (w0d + f * (w1d - w0d));
+                if (k == 0 && w > ext[u]) ext[u] = w;
+                if (k == 1 && w < ext[u]) ext[u] = w;
+            }
+        }
+        for (u = 0; u < nu; u++) {
+            w0 = MAX (0, MIN (zero_w, (int)ext[u]));
+            w1 = MIN (nw - 1, MAX (zero_w, (int)ext[u]));
+            if ((int)ext[u] == zero_w) continue;
+            for (w = w0; w <= w1; w++) {
+                if (vert) R->fill[k][(size_t)(ny - 1 - u) * nx + w]++;
+                else      R->fill[k][(size_t)(ny - 1 - w) * nx + u]++;
+            }
+        }
+        GMT_free (GMT, ext);
+    }
+}
+
+void plot_density (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, struct PSL_CTRL *PSL, struct PSSAC_RASTER *R)
+{
+    /* -I: shade each pixel from white towards the fill colors and then the pen color,
+     * by log(1+count) relative to the largest count, and plot the raster as one image */
+    size_t i, n = (size_t)R->nx * R->ny;
+    int k, c;
+    unsigned int max[3] = {0, 0, 0};
+    unsigned int *layer[3] = {R->fill[0], R->fill[1], R->line};
+    const double *rgb[3] = {Ctrl->G.fill[0].rgb, Ctrl->G.fill[1].rgb, Ctrl->W.pen.rgb};
+    double a, v[3];
+    unsigned char *image = GMT_memory (GMT, NULL, 3 * n, unsigned char);
+
+    for (k = 0; k < 3; k++)
+        if (layer[k]) for (i = 0; i < n; i++) max[k] = MAX (max[k], layer[k][i]);
+
+#ifdef _OPENMP
+#pragma omp parallel for private(i,k,c,a,v) shared(n,layer,max,rgb,image)
+#endif
+    for (i = 0; i < n; i++) {
+        v[0] = v[1] = v[2] = 1.0;
+        for (k = 0; k < 3; k++) {
+            if (!layer[k] || max[k] == 0 || layer[k][i] == 0) continue;
+            a = log1p ((double)layer[k][i]) / log1p ((double)max[k]);
+            for (c = 0; c < 3; c++) v[c] = (1.0 - a) * v[c] + a * rgb[k][c];
+        }
+        for (c = 0; c < 3; c++) image[3*i+c] = (unsigned char)lrint (255.0 * v[c]);
+    }
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Plotting density image of %d x %d pixels, at most %u line hits per pixel\n", R->nx, R->ny, max[2]);
+    PSL_plotcolorimage (PSL, 0.0, 0.0, R->nx / Ctrl->I.dpi, R->ny / Ctrl->I.dpi, PSL_BL, image, R->nx, R->ny, 24);
+    GMT_free (GMT, image);
+}
+
+int next_stream_trace (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl, FILE *fp, struct SAC_LIST **list, int n_files, size_t *n_alloc, bool geometry)
+{
+    /* -Q: drop the previous record of the stream, read the next one and append it to the list
+     * as a registered trace. Return the new number of traces, which is n_files at the end. */
+    int k;
+    char name[GMT_LEN256];
+    SACHEAD hd;
+    float *data = NULL;
+    struct SAC_LIST *L = *list;
+
+    sprintf (name, "%s-Q/%d", PSSAC_MEM_PREFIX, n_files - 1);
+    if ((k = raw_lookup (name)) >= 0) {
+        free (raw_cache[k].data);
+        drop_raw (k);
+    }
+    if ((data = read_sac_stream (fp, &hd)) == NULL) {
+        if (!feof (fp)) GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Error: broken SAC stream after %d records\n", n_files);
+        return n_files;
+    }
+
+    sprintf (name, "%s-Q/%d", PSSAC_MEM_PREFIX, n_files);
+    pssac_register_trace (name, &hd, data);
+    if ((size_t)n_files == *n_alloc) L = *list = GMT_malloc (GMT, L, n_files, n_alloc, struct SAC_LIST);
+    memset (&L[n_files], 0, sizeof (struct SAC_LIST));
+    L[n_files].file = strdup (name);
+    if (geometry) complete_geometry (GMT, Ctrl, &L[n_files], 1);
+    return n_files + 1;
+}
+
+unsigned int list_trace (struct GMT_CTRL *GMT, struct SAC_LIST **L, unsigned int n, size_t *n_alloc, char *file)
+{
+    /* append file to the list, or all its traces if file is a SAC bundle, and return the new length */
+    int b, i, m = 1;
+    char name[GMT_BUFSIZ];
+
+    if ((b = open_bundle (file)) >= 0) m = bundles[b].bd.n;
+    else open_mseed (file);     /* miniSEED is decoded once here and read from memory */
+    for (i = 0; i < m; i++, n++) {
+        if (n == *n_alloc) *L = GMT_malloc (GMT, *L, n, n_alloc, struct SAC_LIST);
+        if (b >= 0) snprintf (name, GMT_BUFSIZ, "%s#%s", file, bundles[b].bd.member[i]);
+        (*L)[n].file = strdup ((b >= 0) ? name : file);
+    }
+    return n;
+}
+
+int init_sac_list (struct GMT_CTRL *GMT, char **files, unsigned int n_files, struct SAC_LIST **list)
+{
+    unsigned int n = 0, nr, m;
+
+    struct SAC_LIST *L = NULL;
+
+    /* Got a bunch of SAC files or one file in SAC format, or SAC bundles */
+    if (n_files > 1 || (n_files==1 && is_trace(files[0]))) {
+        size_t n_alloc = 0;
+        for (m = 0; m < n_files; m++)
+            n = list_trace (GMT, &L, n, &n_alloc, files[m]);
+        n_files = n;
+    } else {    /* Must read a list file */
+        size_t n_alloc = 0;
+        char *line = NULL, pen[GMT_LEN256] = {""}, file[GMT_LEN256] = {""};
+        double x, y;
+        GMT_set_meminc (GMT, GMT_SMALL_CHUNK);
+        do {
+            if ((line = GMT_Get_Record(GMT->parent, GMT_READ_TEXT, NULL)) == NULL) {
+                if (GMT_REC_IS_ERROR (GMT))   /* Bail if there are any read error */
+                    return (GMT_RUNTIME_ERROR);
+                if (GMT_REC_IS_ANY_HEADER (GMT)) /* skip headers */
+                    continue;
+                if (GMT_REC_IS_EOF(GMT))  /* Reached end of file */
+                    break;
+            }
+
+            nr = sscanf (line, "%s %lf %lf %s", file, &x, &y, pen);
+            if (nr < 1) {
+                GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Read error for sac list file near row %d\n", n);
+                return (EXIT_FAILURE);
+            }
+
+            for (m = n, n = list_trace (GMT, &L, n, &n_alloc, file); m < n; m++) {
+                if (nr>=3) {
+                    L[m].position = true;
+                    L[m].x = x;
+                    L[m].y = y;
+                }
+                if (nr==4) {
+                    L[m].custom_pen = true;
+					if (GMT_getpen (GMT, pen, &L[m].pen)) {
+						GMT_pen_syntax (GMT, 'W', "sets pen attributes [Default pen is %s]:", 3);
+					}
+                }
+            }
+        } while(true);
+        GMT_reset_meminc (GMT);
+        n_files = n;
+    }
+    *list = L;
+
+    return n_files;
+}
+
+int job_files (struct GMT_CTRL *GMT, char *args, char *list, char ***files, int n, size_t *n_alloc)
+{
+    /* -y/-j: append the SAC files of a plot job to files and return their new number.
+     * Files are arguments not starting with '-', the first column of a saclist argument,
+     * and the first column of the saclist sent with the job. SAC bundles and miniSEED files among
+     * them are read into memory instead. args and list are cut into tokens. */
+    char *p, *line, file[GMT_LEN256], buf[GMT_BUFSIZ];
+    FILE *fp;
+
+    for (p = strtok (args, " \t"); p; p = strtok (NULL, " \t")) {
+        if (p[0] == '-' || open_bundle (p) >= 0 || open_mseed (p) >= 0) continue;   /* read once here */
+        if (issac (p)) {
+            if ((size_t)n == *n_alloc) *files = GMT_malloc (GMT, *files, n, n_alloc, char *);
+            (*files)[n++] = strdup (p);
+        }
+        else if ((fp = fopen (p, "r")) != NULL) {
+            while (fgets (buf, GMT_BUFSIZ, fp)) {
+                if (buf[0] == '#' || sscanf (buf, "%255s", file) != 1 || open_bundle (file) >= 0 || open_mseed (file) >= 0) continue;
+                if ((size_t)n == *n_alloc) *files = GMT_malloc (GMT, *files, n, n_alloc, char *);
+                (*files)[n++] = strdup (file);
+            }
+            fclose (fp);
+        }
+    }
+    for (line = (list) ? strtok (list, "\n") : NULL; line; line = strtok (NULL, "\n")) {
+        if (line[0] == '#' || sscanf (line, "%255s", file) != 1 || open_bundle (file) >= 0 || open_mseed (file) >= 0) continue;
+        if ((size_t)n == *n_alloc) *files = GMT_malloc (GMT, *files, n, n_alloc, char *);
+        (*files)[n++] = strdup (file);
+    }
+    return n;
+}
+
+void free_names (struct GMT_CTRL *GMT, char **files, int n)
+{
+    while (n > 0) free (files[--n]);
+    if (files) GMT_free (GMT, files);
+}
+
+int run_server (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl)
+{
+    /* -y: accept plot jobs on a Unix domain socket until a "quit" job arrives.
+     * A job is one line of pssac options and files, optionally followed by a saclist, and
+     * ends when the client shuts down its writing side. Every job runs in a child process
+     * that inherits the GMT session and the raw cache, and writes its PostScript to the socket.
+     * The files of a job are read into the raw cache only while no client is waiting, at most
+     * PSSAC_CHUNK at a time, so later jobs find them there without holding up the others. */
+    int fd, conn, status, ready, m;
+    ssize_t got;
+    int n_files = 0;
+    mode_t mask;
+    time_t deadline;
+    struct timeval wait;
+    struct pollfd pfd;
+    size_t n_buf = 0, n_buf_alloc = 0, n_alloc = 0, n_queue = 0, n_queue_alloc = 0, q = 0;
+    char *buf = NULL, *list, **files = NULL, **queue = NULL;
+    struct sockaddr_un addr;
+    pid_t pid;
+
+    if (strlen (Ctrl->y.socket) >= sizeof (addr.sun_path)) {
+        GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Error: socket path %s is too long\n", Ctrl->y.socket);
+        return (EXIT_FAILURE);
+    }
+    memset (&addr, 0, sizeof (addr));
+    addr.sun_family = AF_UNIX;
+    strcpy (addr.sun_path, Ctrl->y.socket);
+    unlink (Ctrl->y.socket);
+    /* jobs write files as the server user, so only that user may connect */
+    mask = umask (077);
+    if ((fd = socket (AF_UNIX, SOCK_STREAM, 0)) < 0 || bind (fd, (struct sockaddr *)&addr, sizeof (addr)) ||
+        chmod (Ctrl->y.socket, 0600) || listen (fd, 64)) {
+        GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Error: cannot listen on socket %s\n", Ctrl->y.socket);
+        umask (mask);
+        if (fd >= 0) close (fd);
+        return (EXIT_FAILURE);
+    }
+    umask (mask);
+    signal (SIGCHLD, SIG_IGN);     /* finished jobs are reaped by the system */
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Listening for plot jobs on %s\n", Ctrl->y.socket);
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    for (;;) {
+        /* with files still to read, only look for a waiting client before reading the next chunk */
+        if ((ready = poll (&pfd, 1, (q < n_queue || n_files > 0) ? 0 : -1)) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (ready == 0) {
+            if (n_files == 0) {     /* files of the oldest job not yet read; args and list are cut into tokens */
+                n_files = job_files (GMT, queue[q], queue[q+1], &files, 0, &n_alloc);
+                free (queue[q]);  free (queue[q+1]);
+                if ((q += 2) == n_queue) q = n_queue = 0;
+            }
+            if ((m = MIN (n_files, PSSAC_CHUNK)) > 0) warm_raw_traces (GMT, files + n_files - m, m);
+            while (m-- > 0) free (files[--n_files]);
+            continue;
+        }
+        if ((conn = accept (fd, NULL, NULL)) < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        /* read the whole job, giving up on clients that do not send it in time so they cannot hold up others */
+        wait.tv_sec = 1;
+        wait.tv_usec = 0;
+        setsockopt (conn, SOL_SOCKET, SO_RCVTIMEO, &wait, sizeof (wait));
+        deadline = time (NULL) + PSSAC_JOB_WAIT;
+        n_buf = 0;
+        do {
+            if (n_buf + GMT_BUFSIZ + 1 > n_buf_alloc) buf = realloc (buf, n_buf_alloc += GMT_BUFSIZ + 1 + n_buf_alloc);
+            if ((got = read (conn, buf + n_buf, GMT_BUFSIZ)) > 0) n_buf += got;
+        } while ((got > 0 || (got < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK))) && time (NULL) < deadline);
+        if (got != 0) {
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Warning: plot job not received within %d s, dropped.\n", PSSAC_JOB_WAIT);
+            close (conn);
+            continue;
+        }
+        buf[n_buf] = '\0';
+        if ((list = strchr (buf, '\n')) != NULL) *list++ = '\0';
+        else list = buf + n_buf;
+        if (!strcmp (buf, "quit")) {
+            close (conn);
+            break;
+        }
+        GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Plot job: %s\n", buf);
+
+        fflush (stdout);
+        if ((pid = fork ()) == 0) {     /* the job: saclist on stdin, PostScript to the socket */
+            FILE *fp = NULL;
+            close (fd);
+            in_job = true;
+            if (list[0] && (fp = tmpfile ()) != NULL) {
+                fputs (list, fp);
+                fflush (fp);
+                lseek (fileno (fp), 0, SEEK_SET);
+                dup2 (fileno (fp), STDIN_FILENO);
+            }
+            else {
+                int null = open ("/dev/null", O_RDONLY);
+                dup2 (null, STDIN_FILENO);
+            }
+            dup2 (conn, STDOUT_FILENO);
+            status = GMT_Call_Module (GMT->parent, THIS_MODULE_NAME, GMT_MODULE_CMD, buf);
+            fflush (stdout);
+            _exit (status);
+        }
+        if (pid < 0)
+            GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Error: cannot fork plot job: %s\n", buf);
+        else {      /* the job reads its own files; keep them for the next ones */
+            if (n_queue == n_queue_alloc) queue = GMT_malloc (GMT, queue, n_queue, &n_queue_alloc, char *);
+            queue[n_queue++] = strdup (buf);
+            if (n_queue == n_queue_alloc) queue = GMT_malloc (GMT, queue, n_queue, &n_queue_alloc, char *);
+            queue[n_queue++] = strdup (list);
+        }
+        close (conn);
+    }
+    for (; q < n_queue; q++) free (queue[q]);
+    if (queue) GMT_free (GMT, queue);
+    free_names (GMT, files, n_files);
+    free (buf);
+    close (fd);
+    unlink (Ctrl->y.socket);
+    return (GMT_NOERROR);
+}
+
+int run_batch (struct GMT_CTRL *GMT, struct PSSAC_CTRL *Ctrl)
+{
+    /* -j: run the plot jobs of a job file. Each line names the output PostScript file, followed by
+     * pssac options and files. The SAC files of all jobs are read once into the raw cache, and the
+     * jobs run in up to <nproc> child processes that share them. */
+    int n, n_jobs = 0, n_files = 0, running = 0, n_failed = 0, status;
+    size_t n_job_alloc = 0, n_alloc = 0;
+    char line[GMT_BUFSIZ], out[GMT_LEN256], *args, **job = NULL, **files = NULL;
+    FILE *fp;
+    pid_t pid;
+
+    if ((fp = fopen (Ctrl->j.file, "r")) == NULL) {
+        GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Error: cannot open job file %s\n", Ctrl->j.file);
+        return (EXIT_FAILURE);
+    }
+    while (fgets (line, GMT_BUFSIZ, fp)) {
+        line[strcspn (line, "\r\n")] = '\0';
+        if (line[0] == '#' || sscanf (line, "%255s", out) != 1) continue;
+        if ((size_t)n_jobs == n_job_alloc) job = GMT_malloc (GMT, job, n_jobs, &n_job_alloc, char *);
+        job[n_jobs++] = strdup (line);
+        args = strdup (strstr (line, out) + strlen (out));
+        n_files = job_files (GMT, args, NULL, &files, n_files, &n_alloc);
+        free (args);
+    }
+    fclose (fp);
+
+    GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Reading %d SAC files for %d plot jobs\n", n_files, n_jobs);
+    warm_raw_traces (GMT, files, n_files);
+    free_names (GMT, files, n_files);
+
+    for (n = 0; n < n_jobs || running > 0; ) {
+        if (n < n_jobs && running < Ctrl->j.nproc) {
+            sscanf (job[n], "%255s", out);
+            args = strstr (job[n], out) + strlen (out);
+            GMT_Report (GMT->parent, GMT_MSG_VERBOSE, "Plot job %d: %s >%s\n", n, args, out);
+            fflush (stdout);
+            if ((pid = fork ()) == 0) {     /* the job, writing to its own PostScript file */
+                in_job = true;
+                if (freopen (out, "w", stdout) == NULL) _exit (EXIT_FAILURE);
+                status = GMT_Call_Module (GMT->parent, THIS_MODULE_NAME, GMT_MODULE_CMD, args);
+                fflush (stdout);
+                _exit (status);
+            }
+            if (pid < 0) {
+                GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Error: cannot fork plot job %d\n", n);
+                n_failed++;
+            }
+            else
+                running++;
+            n++;
+        }
+        else if (wait (&status) > 0) {
+            running--;
+            if (!WIFEXITED (status) || WEXITSTATUS (status)) n_failed++;
+        }
+        else
+            break;
+    }
+    for (n = 0; n < n_jobs; n++) free (job[n]);
+    if (job) GMT_free (GMT, job);
+
+    if (n_failed) GMT_Report (GMT->parent, GMT_MSG_NORMAL, "Error: %d of %d plot jobs failed\n", n_failed, n_jobs);
+    return (n_failed ? EXIT_FAILURE : GMT_NOERROR);
+}
+
+int GMT_pssac (void *V_API, int mode, void *args)
+{	/* High-level function that implements the pssac task */
+	bool old_is_world;
+	int error = GMT_NOERROR;
+
+	struct GMT_PEN current_pen;
+	struct PSSAC_CTRL *Ctrl = NULL;
+	struct GMT_CTRL *GMT = NULL, *GMT_cpy = NULL;		/* General GMT interal parameters */
+	struct GMT_OPTION *options = NULL;
+	struct PSL_CTRL *PSL = NULL;		/* General PSL interal parameters */
+	struct GMTAPI_CTRL *API = GMT_get_API_ptr (V_API);	/* Cast from void to GMTAPI_CTRL pointer */
+
+    struct SAC_LIST *L = NULL;
+    int n_files;
+    double yscale = 1.0;
+    double y0 = 0.0, x0;
+    bool read_from_ascii;
+    int n, i;
+    SACHEAD hd;
+    double *x = NULL, *y = NULL;
+    double tref;
+    bool render = false, geometry;
+    size_t n_alloc;
+    FILE *stream = NULL;    /* -Q */
+    uint64_t sig = 0;
+    char pkey[GMT_BUFSIZ] = {""}, pcache[GMT_BUFSIZ] = {""};
+    struct PSSAC_PLOT P;
+    struct PSSAC_RASTER R = {0, 0, NULL, {NULL, NULL}};
+    struct PSSAC_JOIN *join = NULL;    /* -S: end of the previous segment plotted */
+
+	/*----------------------- Standard module initialization and parsing ----------------------*/
+
+	if (API == NULL) return (GMT_NOT_A_SESSION);
+	if (mode == GMT_MODULE_PURPOSE) return (GMT_pssac_usage (API, GMT_MODULE_PURPOSE));	/* Return the purpose of program */
+	options = GMT_Create_Options (API, mode, args);	if (API->error) return (API->error);	/* Set or get option list */
+
+	if (!options || options->option == GMT_OPT_USAGE) bailout (GMT_pssac_usage (API, GMT_USAGE));	/* Return the usage message */
+	if (options->option == GMT_OPT_SYNOPSIS) bailout (GMT_pssac_usage (API, GMT_SYNOPSIS));	/* Return the synopsis */
+
+	/* Parse the command-line arguments; return if errors are encountered */
+
+	GMT = GMT_begin_module (API, THIS_MODULE_LIB, THIS_MODULE_NAME, &GMT_cpy); /* Save current state */
+	if (GMT_Parse_Common (API, GMT_PROG_OPTIONS, options)) Return (API->error);
+
+	Ctrl = New_pssac_Ctrl (GMT);	/* Allocate and initialize a new control structure */
+	if ((error = GMT_pssac_parse (GMT, Ctrl, options)) != 0) Return (error);
+
+
+	/*---------------------------- This is the pssac main code ----------------------------*/
+
+    if (Ctrl->j.active) Return (run_batch (GMT, Ctrl));   /* -j: run the plot jobs of a job file */
+    if (Ctrl->y.active) Return (run_server (GMT, Ctrl));  /* -y: serve plot jobs until told to quit */
+    if (Ctrl->e.active && read_stations (GMT, Ctrl->e.file)) Return (GMT_RUNTIME_ERROR);
+
+	current_pen = Ctrl->W.pen;
+
+	if (GMT_err_pass (GMT, GMT_map_setup (GMT, GMT->common.R.wesn), "")) Return (GMT_PROJECTION_ERROR);
+
+	if ((PSL = GMT_plotinit (GMT, options)) == NULL) Return (GMT_RUNTIME_ERROR);
+
+	GMT_plane_perspective (GMT, GMT->current.proj.z_project.view_plane, GMT->current.proj.z_level);
+	GMT_plotcanvas (GMT);	/* Fill canvas if requested */
+
+	GMT_setpen (GMT, &current_pen);
 
 	if (Ctrl->D.active) PSL_setorigin (PSL, Ctrl->D.dx, Ctrl->D.dy, 0.0, PSL_FWD);	/* Shift plot a bit */
 
 	old_is_world = GMT->current.map.is_world;
 
-    read_from_ascii = (Ctrl->In.n == 0) || (Ctrl->In.n == 1 && !issac(Ctrl->In.file[0]));
+    read_from_ascii = (Ctrl->In.n == 0 && !Ctrl->Q.active) || (Ctrl->In.n == 1 && !is_trace(Ctrl->In.file[0]));
     if (read_from_ascii) {      /* Got a ASCII file or read from stdin */
         GMT_Report (API, GMT_MSG_LONG_VERBOSE, "Reading from saclist file or stdin\n");
         if (GMT_Init_IO (API, GMT_IS_TEXTSET, GMT_IS_NONE, GMT_IN, GMT_ADD_DEFAULT, 0, options) != GMT_OK) {    /* Register data input */
@@ -605,92 +3871,151 @@ int GMT_pssac (void *V_API, int mode, void *args)
             Return (API->error);
         }
     }
-    n_files = init_sac_list (GMT, Ctrl->In.file, Ctrl->In.n, &L);
+    n_files = (Ctrl->In.n == 0 && Ctrl->Q.active) ? 0 : init_sac_list (GMT, Ctrl->In.file, Ctrl->In.n, &L);
+    n_alloc = n_files;
 
     if (read_from_ascii && GMT_End_IO (API, GMT_IN, 0) != GMT_OK) { /* Disables further data input */
         Return (API->error);
     }
-	GMT_Report (API, GMT_MSG_VERBOSE, "Collecting %ld SAC files to plot.\n", n_files);
+	GMT_Report (API, GMT_MSG_VERBOSE, "Collecting %d SAC files to plot.\n", n_files);
 
-    for (n=0; n < n_files; n++) {  /* Loop over all SAC files */
-	    GMT_Report (API, GMT_MSG_VERBOSE, "Plotting SAC file %d: %s\n", n, L[n].file);
+    if (Ctrl->A.active) {   /* -A: plot one rotated trace per pair of horizontal components */
+        for (n = 0; n < n_files; n++) split_pair (&L[n]);
+        n_files = pair_components (GMT, L, n_files);
+        GMT_Report (API, GMT_MSG_VERBOSE, "Collecting %d pairs of horizontal components to rotate.\n", n_files);
+    }
 
-        /* -T: determine the reference time for all times in pssac */
-        tref = 0.0;
-        if (Ctrl->T.active) {
-            /* read SAC header only to determine the reference time */
-            if ((read_sac_head (L[n].file, &hd))) {  /* skip or not */
-                GMT_Report (API, GMT_MSG_NORMAL, "=> %s: Warning: unable to read, skipped.\n", L[n].file);
-                continue;
-            }
-            /* +t */
-            if (Ctrl->T.align) tref += *((float *)&hd + TMARK + Ctrl->T.tmark);
-            /* +r */
-            if (Ctrl->T.reduce) {
-                if (hd.dist == SAC_FLOAT_UNDEF) {
-                    GMT_Report (API, GMT_MSG_NORMAL, "=> %s: Warning: dist not defined in SAC header, skipped.\n", L[n].file);
-                    continue;
-                }
-                tref += fabs(hd.dist)/Ctrl->T.reduce_vel;
-            }
-            /* +s */
-            tref -= Ctrl->T.shift;
-        }
-        GMT_Report (API, GMT_MSG_VERBOSE, "=> %s: reference time is %g\n", L[n].file, tref);
+    if (Ctrl->C.n > 1) {    /* -C: one trace per file and window */
+        n_files = expand_windows (GMT, Ctrl, &L, n_files);
+        n_alloc = n_files;
+        GMT_Report (API, GMT_MSG_VERBOSE, "Plotting %d windows of each file.\n", Ctrl->C.n);
+    }
 
-        /* read SAC data */
-        if (!Ctrl->C.active) {
-            if ((data = read_sac (L[n].file, &hd)) == NULL) {
-                GMT_Report (API, GMT_MSG_NORMAL, "=> %s: Warning: unable to read, skipped.\n", L[n].file);
-                continue;
-            }
-        } else {
-            if ((data = read_sac_pdw (L[n].file, &hd, 10, tref+Ctrl->C.t0, tref+Ctrl->C.t1)) == NULL) {
-                GMT_Report (API, GMT_MSG_NORMAL, "=> %s: Warning: unable to read, skipped.\n", L[n].file);
-                continue;
-            }
-        }
+    if (!GMT_IS_LINEAR(GMT) && !Ctrl->m.active) {
+        GMT_Report (API, GMT_MSG_NORMAL, "Error: -m option is needed in geographic plots.\n");
+        Return(EXIT_FAILURE);
+    }
+    /* -k: cache directory shared by pssac calls */
+    if (Ctrl->k.active && mkdir (Ctrl->k.dir, 0777) == 0)
+        GMT_Report (API, GMT_MSG_VERBOSE, "Created cache directory %s\n", Ctrl->k.dir);
 
-        /* prepare datas */
-        x = GMT_memory(GMT, 0, hd.npts, double);
-        y = GMT_memory(GMT, 0, hd.npts, double);
-        double dt;
-        if (GMT_IS_LINEAR(GMT)) dt = hd.delta;
-        else if (Ctrl->m.active) dt = hd.delta/Ctrl->m.sec_per_measure;
-        else {
-            GMT_Report (API, GMT_MSG_NORMAL, "Error: -m option is needed in geographic plots.\n");
+    /* -Zb: make sure every trace has an up-to-date pyramid */
+    if (Ctrl->Z.build) build_pyramids (GMT, L, n_files);
+
+    /* -l: continue traces from the last run */
+    if (Ctrl->l.active) read_live_state (GMT, Ctrl, L, n_files);
+
+    if (!GMT_IS_LINEAR(GMT) && Ctrl->L.active) {
+        GMT_Report (API, GMT_MSG_NORMAL, "Error: -L option works in linear plots only.\n");
+        Return(EXIT_FAILURE);
+    }
+
+    /* fill in undefined gcarc, az, baz and dist from coordinates if they are used */
+    geometry = Ctrl->H.active || Ctrl->A.active || Ctrl->T.reduce || Ctrl->T.phase || Ctrl->M.dist_scaling ||
+        (Ctrl->E.active && strchr ("abdk", Ctrl->E.keys[0]));
+    if (geometry) complete_geometry (GMT, Ctrl, L, n_files);
+
+    /* -S: segments of one channel form one trace */
+    if (Ctrl->S.active) {
+        n = stitch_segments (GMT, Ctrl, L, n_files);
+        GMT_Report (API, GMT_MSG_VERBOSE, "Stitching %d SAC files into %d traces.\n", n_files, n);
+        join = GMT_memory (GMT, NULL, 1, struct PSSAC_JOIN);
+        join->trace = -1;
+    }
+
+    /* -F with FFT operations: process all traces up front so the work runs across threads.
+     * Not with -S, which keeps only one segment in memory. */
+    if (Ctrl->F.spectral && !Ctrl->S.active && !Ctrl->k.plot) preload_traces (GMT, Ctrl, L, n_files);
+
+    /* -T+c: the shift of each trace depends on all other traces */
+    if (Ctrl->T.xcorr) align_by_xcorr (GMT, Ctrl, L, n_files);
+
+    /* -N: one stacked trace per bin */
+    if (Ctrl->N.active) {
+        n = stack_traces (GMT, Ctrl, &L, n_files);
+        GMT_Report (API, GMT_MSG_VERBOSE, "Stacking %d SAC files into %d bins.\n", n_files, n);
+        n_files = n;
+    }
+
+    /* -M<size>/g|m|p: one scale factor determined from all traces */
+    if (Ctrl->M.active && Ctrl->M.global) {
+        for (n = 0; n < n_files && !L[n].resumed; n++);
+        if (n < n_files)    /* -l: keep the scale of the last run for all traces */
+            yscale = L[n].yscale;
+        else if ((yscale = global_yscale (GMT, Ctrl, L, n_files)) <= 0.0) {
+            GMT_Report (API, GMT_MSG_NORMAL, "Error: unable to determine a global scale factor for -M.\n");
             Return(EXIT_FAILURE);
         }
-        for (i=0; i<hd.npts; i++) {
-            x[i] = i * dt;
-            y[i] = data[i];
+        GMT_Report (API, GMT_MSG_VERBOSE, "Global yscale of all traces: %g\n", yscale);
+    }
+
+    /* -k+p: coordinates are cached unless a trace depends on its neighbours */
+    render = Ctrl->k.plot && !Ctrl->L.active && !Ctrl->S.active && !Ctrl->T.xcorr && !Ctrl->l.active;
+    if (render && Ctrl->M.active && (Ctrl->M.global || Ctrl->M.scaleALL)) {   /* scale depends on other traces */
+        char buf[GMT_BUFSIZ];
+        for (n = 0; n < n_files; n++) {
+            buf[0] = '\0';
+            stat_key (buf, L[n].file);
+            sig = fnv1a (sig, buf);
+        }
+    }
+
+    if (Ctrl->I.active) {   /* -I: density raster covering the plot */
+        R.nx = MAX (1, (int)lrint (GMT->current.map.width * Ctrl->I.dpi));
+        R.ny = MAX (1, (int)lrint (GMT->current.map.height * Ctrl->I.dpi));
+        R.line = GMT_memory (GMT, NULL, (size_t)R.nx * R.ny, unsigned int);
+        for (i = 0; i <= 1; i++)
+            if (Ctrl->G.active[i]) R.fill[i] = GMT_memory (GMT, NULL, (size_t)R.nx * R.ny, unsigned int);
+    }
+
+    if (Ctrl->Q.active && (stream = (Ctrl->Q.file[0]) ? fopen (Ctrl->Q.file, "rb") : stdin) == NULL) {
+        GMT_Report (API, GMT_MSG_NORMAL, "Error: cannot open SAC stream %s\n", Ctrl->Q.file);
+        Return (EXIT_FAILURE);
+    }
+
+    /* Loop over all SAC files, then over the records of the -Q stream as they arrive */
+    for (n=0; n < n_files || (stream && (n_files = next_stream_trace (GMT, Ctrl, stream, &L, n_files, &n_alloc, geometry)) > n); n++) {
+	    GMT_Report (API, GMT_MSG_VERBOSE, "Plotting SAC file %d: %s\n", n, L[n].file);
+
+        /* -I: load the next traces in parallel, a chunk at a time. Otherwise ask the kernel
+         * to read them ahead in disk order. */
+        if (n % PSSAC_CHUNK == 0) {
+            if (Ctrl->I.active) preload_traces (GMT, Ctrl, &L[n], MIN (PSSAC_CHUNK, n_files - n));
+            else advise_traces (GMT, Ctrl, &L[n], MIN (PSSAC_CHUNK, n_files - n));
         }
-        GMT_free (GMT, data);
 
-        /* -F: data preprocess */
-        for (i=0; Ctrl->F.keys[i]!='\0'; i++) {
-            switch (Ctrl->F.keys[i]) {
-                case 'i': integral(y, hd.delta, hd.npts); hd.npts--; break;
-                case 'q':   sqr(y, hd.npts); break;
-                case 'r': rmean(y, hd.npts); break;
-                default: break;
+        if (render && !plot_cache_name (Ctrl, &L[n], n, sig, pkey, pcache) && !L[n].bad &&
+            !read_cached_plot (GMT, pkey, pcache, &P)) {
+            GMT_Report (API, GMT_MSG_VERBOSE, "=> %s: plotted from cache %s\n", L[n].file, pcache);
+            yscale = P.yscale;
+            if (Ctrl->I.active) raster_trace (GMT, Ctrl, &R, &P);
+            else draw_trace (GMT, Ctrl, PSL, &L[n], &P);
+            free_plot (GMT, &P);
+            if (L[n].loaded || L[n].prefetched) {
+                GMT_free (GMT, L[n].data);
+                L[n].data = NULL;
+                L[n].loaded = L[n].prefetched = false;
             }
+            continue;
         }
 
-        /* recalculate depmin, depmax, depmen for further use */
-        hd.depmax=-1.e20; hd.depmin=1.e20; hd.depmen=0.;
-        for(i=0; i<hd.npts; i++){
-            hd.depmax = hd.depmax > y[i] ? hd.depmax : y[i];
-            hd.depmin = hd.depmin < y[i] ? hd.depmin : y[i];
-            hd.depmen += y[i];
+        if (L[n].bad || (!L[n].loaded && load_sac_trace (GMT, Ctrl, &L[n]))) continue;
+        hd = L[n].hd;
+        y = L[n].data;
+        tref = L[n].tref;
+
+        if (Ctrl->S.active) {   /* -S: trim the overlap with, or join to, the previous segment */
+            if (join_segment (GMT, Ctrl, &L[n], join)) continue;
+            hd = L[n].hd;
+            y = L[n].data;
         }
-        hd.depmen = hd.depmen/hd.npts;
-        GMT_Report (API, GMT_MSG_VERBOSE, "=> %s: depmax=%g depmin=%g depmen=%g\n", L[n].file, hd.depmax, hd.depmin, hd.depmen);
 
         /* -M: determine yscale for multiple traces */
         if (Ctrl->M.active) {
-            if (Ctrl->M.norm || (Ctrl->M.scaleALL && n==0)) {
-                yscale = Ctrl->M.size / (hd.depmax - hd.depmin);
+            if (L[n].resumed && !Ctrl->M.global) {  /* -l: keep the scale of the last run */
+                yscale = L[n].yscale;
+            } else if (Ctrl->M.norm || (Ctrl->M.scaleALL && n==0)) {
+                yscale = Ctrl->M.size / (Ctrl->S.active ? L[n].amp : hd.depmax - hd.depmin);
             } else if (Ctrl->M.dist_scaling) {
                 yscale = Ctrl->M.size * pow(fabs(hd.dist), Ctrl->M.alpha);
             }
@@ -700,6 +4025,24 @@ int GMT_pssac (void *V_API, int mode, void *args)
             hd.depmen *= yscale;
         }
         GMT_Report (API, GMT_MSG_VERBOSE, "=> %s: yscale of trace: %g\n", L[n].file, yscale);
+        L[n].yscale = yscale;
+
+        if (Ctrl->L.active) {   /* -L: helicorder rows instead of one trace */
+            if (L[n].custom_pen) GMT_setpen (GMT, &L[n].pen);
+            plot_helicorder (GMT, Ctrl, y, &hd, hd.b - tref, L[n].custom_pen ? L[n].pen.mode : current_pen.mode);
+            if (L[n].custom_pen) GMT_setpen (GMT, &current_pen);
+            GMT_free (GMT, y);
+            L[n].data = NULL;
+            L[n].loaded = false;
+            continue;
+        }
+
+        /* prepare datas */
+        x = GMT_memory(GMT, 0, hd.npts, double);
+        double dt;
+        if (GMT_IS_LINEAR(GMT)) dt = hd.delta;
+        else dt = hd.delta/Ctrl->m.sec_per_measure;
+        for (i=0; i<hd.npts; i++) x[i] = i * dt;
 
         /* -v: swap x and y */
         if (Ctrl->v.active) {
@@ -723,9 +4066,8 @@ int GMT_pssac (void *V_API, int mode, void *args)
             x0 = L[n].x;
             y0 = L[n].y;
         } else {
-            /* determine X0 */
-            if (!Ctrl->C.active) x0 = hd.b - tref;
-            else x0 = Ctrl->C.t0;
+            /* determine X0, hd.b is the begin of the -C window if -C is used */
+            x0 = hd.b - tref;
 
             /* determin Y0 */
             unsigned int user = 0; /* default using user0 */
@@ -760,7 +4102,7 @@ int GMT_pssac (void *V_API, int mode, void *args)
                         y0 = hd.dist;
                         break;
                     case 'n':
-                        y0 = n;
+                        y0 = Ctrl->S.active ? L[n].trace : n / MAX (Ctrl->C.n, 1);
                         if (Ctrl->E.keys[1]!='\0') y0 += atof(&Ctrl->E.keys[1]);
                         break;
                     case 'u':  /* user0 to user9 */
@@ -784,6 +4126,11 @@ int GMT_pssac (void *V_API, int mode, void *args)
             }
         }
 
+        if (Ctrl->C.active && Ctrl->C.shift[L[n].win] != 0.0) {   /* -C+o: offset of the window */
+            double shift = GMT_IS_LINEAR(GMT) ? Ctrl->C.shift[L[n].win] : Ctrl->C.shift[L[n].win] / Ctrl->m.sec_per_measure;
+            if (Ctrl->v.active) y0 += shift;
+            else x0 += shift;
+        }
         GMT_Report (API, GMT_MSG_VERBOSE, "=> %s: location of trace: (%g, %g)\n", L[n].file, x0, y0);
         for (i=0; i<hd.npts; i++) {
             x[i] += x0;
@@ -811,42 +4158,30 @@ int GMT_pssac (void *V_API, int mode, void *args)
             plot_pen[0] = PSL_MOVE;
         }
 
-        /* plot trace */
-        if (L[n].custom_pen) {
-	        current_pen = L[n].pen;
-            GMT_setpen (GMT, &L[n].pen);
-        }
-        GMT_plot_line (GMT, xp, yp, plot_pen, npts, current_pen.mode);
-        if (L[n].custom_pen) {
-	        current_pen = Ctrl->W.pen;
-            GMT_setpen (GMT, &current_pen);
-        }
-
-        /* paint trace */
-        for (i=0; i<=1; i++) { /* 0=positive; 1=negative */
-            if (Ctrl->G.active[i]) {
-                double zero = 0.0;
-                if (!Ctrl->v.active) zero = Ctrl->G.zero[i]*yscale + y0;
-                else                 zero = Ctrl->G.zero[i]*yscale + x0;
+        P.n = hd.npts;  P.x = x;  P.y = y;
+        P.npts = npts;  P.xp = xp;  P.yp = yp;  P.pen = plot_pen;
+        P.x0 = x0;  P.y0 = y0;  P.yscale = yscale;
+        if (render && pcache[0]) write_cached_plot (GMT, pkey, pcache, &P);    /* before -G reuses the plot arrays */
+        if (Ctrl->I.active) raster_trace (GMT, Ctrl, &R, &P);
+        else draw_trace (GMT, Ctrl, PSL, &L[n], &P);
 
-                if (!Ctrl->G.cut[i]) {
-                    if (!Ctrl->v.active) {
-                        Ctrl->G.t0[i] = x[0];
-                        Ctrl->G.t1[i] = x[hd.npts-1];
-                    } else {
-                        Ctrl->G.t0[i] = y[0];
-                        Ctrl->G.t1[i] = y[hd.npts-1];
-                    }
-                }
-                GMT_Report (API, GMT_MSG_VERBOSE, "=> %s: Painting traces: zero=%g t0=%g t1=%g\n",
-                        L[n].file, zero, Ctrl->G.t0[i], Ctrl->G.t1[i]);
-                paint_phase(GMT, Ctrl, PSL, x, y, npts, zero, Ctrl->G.t0[i], Ctrl->G.t1[i], i);
-            }
-        }
         GMT_free(GMT, x);
         GMT_free(GMT, y);
+        L[n].data = NULL;
+        L[n].loaded = false;
     }
 
+    if (Ctrl->I.active) {
+        plot_density (GMT, Ctrl, PSL, &R);
+        GMT_free (GMT, R.line);
+        for (i = 0; i <= 1; i++) if (R.fill[i]) GMT_free (GMT, R.fill[i]);
+    }
+
+    if (stream && stream != stdin) fclose (stream);
+    if (join) GMT_free (GMT, join);
+
+    if (Ctrl->l.active) write_live_state (GMT, Ctrl, L, n_files);
+
 	if (Ctrl->D.active) PSL_setorigin (PSL, -Ctrl->D.dx, -Ctrl->D.dy, 0.0, PSL_FWD);	/* Reset shift */
 
 	PSL_setdash (PSL, NULL, 0);
@@ -0,0 +1,26 @@
+/*******************************************************************************
+    Name:     pssac.h
+
+    Purpose:  prototype for passing traces in memory to pssac
+
+    Notes:
+        A registered trace is plotted by giving "@mem:<name>" to pssac
+        wherever a SAC file name is expected, on the command line or in a
+        saclist. pssac reads the samples in place and never frees them,
+        so they must stay valid until the trace is unregistered. Register
+        and unregister traces between calls of GMT_pssac, not during one.
+
+*******************************************************************************/
+
+#ifndef _PSSAC_H
+#define _PSSAC_H
+
+#include "sacio.h"
+
+/* prefix of the names of registered traces */
+#define PSSAC_MEM_PREFIX "@mem:"
+
+int pssac_register_trace(const char *name, const SACHEAD *hd, float *data);
+int pssac_unregister_trace(const char *name);
+
+#endif /* pssac.h */
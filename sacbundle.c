@@ -0,0 +1,71 @@
+/*******************************************************************************
+ *                                 sacbundle.c                                 *
+ *  Pack SAC files into one SAC bundle, so that pssac reads a gather with one  *
+ *  open:                                                                      *
+ *      sacbundle <bundle> [<sacfile>...]                                      *
+ *                                                                             *
+ *  Without SAC files on the command line, their names are read from the       *
+ *  first column of standard input. Each trace is named by its file name,      *
+ *  with the directory removed, and is plotted by pssac as <bundle>#<name>.    *
+ *  The names must differ.                                                     *
+ *                                                                             *
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sacio.h"
+
+int main (int argc, char *argv[])
+{
+    int i, j, n = 0, n_alloc = 0, status;
+    char buf[BUFSIZ], file[BUFSIZ], *c, **files = NULL, **member;
+    SACHEAD *hd;
+    float **data;
+
+    if (argc < 2) {
+        fprintf (stderr, "usage: sacbundle <bundle> [<sacfile>...]\n");
+        return EXIT_FAILURE;
+    }
+
+    for (i = 2; i < argc; i++) {
+        if (n == n_alloc) files = realloc (files, (n_alloc = 2 * n_alloc + 64) * sizeof (char *));
+        files[n++] = strdup (argv[i]);
+    }
+    if (argc == 2) {
+        while (fgets (buf, BUFSIZ, stdin)) {
+            if (buf[0] == '#' || sscanf (buf, "%s", file) != 1) continue;
+            if (n == n_alloc) files = realloc (files, (n_alloc = 2 * n_alloc + 64) * sizeof (char *));
+            files[n++] = strdup (file);
+        }
+    }
+
+    member = (char **)calloc (n + 1, sizeof (char *));
+    hd = (SACHEAD *)calloc (n + 1, sizeof (SACHEAD));
+    data = (float **)calloc (n + 1, sizeof (float *));
+    for (i = 0; i < n; i++) {
+        if ((data[i] = read_sac (files[i], &hd[i])) == NULL) return EXIT_FAILURE;
+        member[i] = ((c = strrchr (files[i], '/')) != NULL) ? c + 1 : files[i];
+        if (strlen (member[i]) >= SAC_BUNDLE_NAME) {
+            fprintf (stderr, "sacbundle: %s: name longer than %d characters\n", files[i], SAC_BUNDLE_NAME - 1);
+            return EXIT_FAILURE;
+        }
+        for (j = 0; j < i; j++) {    /* <bundle>#<name> must name one trace */
+            if (strcmp (member[i], member[j])) continue;
+            fprintf (stderr, "sacbundle: %s and %s have the same name %s\n", files[j], files[i], member[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    status = write_sac_bundle (argv[1], n, member, hd, data);
+
+    for (i = 0; i < n; i++) {
+        free (data[i]);
+        free (files[i]);
+    }
+    free (files);
+    free (member);
+    free (hd);
+    free (data);
+    return (status) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -5,11 +5,23 @@
  *      read_sac         read SAC binary data                                  *
  *      read_sac_xy      read SAC binary XY data                               *
  *      read_sac_pdw     read SAC data in a partial data window (cut option)   *
+ *      read_sac_windows read several windows of SAC data with one open        *
+ *      sac_advise       hint the kernel to read a SAC file in the background  *
+ *      read_sac_range   read a range of samples with a positioned read        *
+ *      read_sac_stream  read the next SAC record from a stream                *
  *      write_sac        Write SAC binary data                                 *
+ *      write_sac_head   Rewrite SAC header of an existing file in place       *
  *      write_sac_xy     Write SAC binary XY data                              *
  *      new_sac_head     Create a new minimal SAC header                       *
  *      sac_head_index   Find the offset of specified SAC head fields          *
  *      issac            Check if a file in in SAC format                      *
+ *      sac_epoch        Absolute reference time in seconds since 1970         *
+ *      write_sac_pyramid  Write min/max pyramid sidecar of a SAC file         *
+ *      read_sac_pyramid   Read one level of the min/max pyramid sidecar       *
+ *      write_sac_bundle   Write SAC traces into one bundle file               *
+ *      read_sac_bundle    Read all traces of a bundle with one open           *
+ *      free_sac_bundle    Release a bundle read by read_sac_bundle            *
+ *      issacbundle        Check if a file is a bundle of SAC traces           *
  *                                                                             *
  *  Author: Dongdong Tian @ USTC                                               *
  *                                                                             *
@@ -29,15 +41,61 @@
 #include <string.h>
 #include <math.h>
 #include <ctype.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "sacio.h"
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+/* windows of read_sac_windows at most this many samples apart are read together */
+#define SAC_WINDOW_GAP  1024
+
+/* kinds of SAC files by their first bytes */
+#define SAC_PLAIN   0
+#define SAC_GZIP    1   /* 1f 8b */
+#define SAC_ZSTD    2   /* 28 b5 2f fd */
+
+/* a SAC file, read directly or through a streaming decompressor */
+typedef struct {
+    FILE   *strm;
+    int     type;           /* SAC_PLAIN, SAC_GZIP or SAC_ZSTD */
+#ifdef HAVE_ZLIB
+    gzFile  gz;
+#endif
+#ifdef HAVE_ZSTD
+    ZSTD_DCtx     *zd;
+    ZSTD_inBuffer  in;
+    char   *inbuf;
+    size_t  pos;            /* decompressed bytes read so far */
+    int     nframe;         /* frames in the seek table of a seekable file, 0 if none */
+    long   *cpos;           /* start of each frame in the file, nframe+1 values */
+    size_t *dpos;           /* start of each frame in the decompressed data */
+#endif
+} SACFILE;
+
 /* function prototype for local use */
 static void    byte_swap       (char *pt, size_t n);
 static int     check_sac_nvhdr (const int nvhdr);
 static void    map_chdr_in     (char *memar, char *buff);
-static int     read_head_in    (const char *name, SACHEAD *hd, FILE *strm);
+static int     read_head_in    (const char *name, SACHEAD *hd, SACFILE *strm);
 static void    map_chdr_out    (char *memar, char *buff);
 static int     write_head_out  (const char *name, SACHEAD hd, FILE *strm);
+static char   *pyramid_name    (const char *name);
+static SACFILE *sac_open       (const char *name);
+static int     sac_read        (SACFILE *f, void *buf, size_t n);
+static int     sac_skip        (SACFILE *f, size_t n);
+static void    sac_willneed    (SACFILE *f, size_t skip, size_t n);
+static void    sac_close       (SACFILE *f);
+#ifdef HAVE_ZSTD
+static void    zstd_seek_table (SACFILE *f);
+#endif
 
 /* a SAC structure containing all null values */
 static SACHEAD sac_null = {
@@ -93,17 +151,17 @@ static SACHEAD sac_null = {
  */
 int read_sac_head(const char *name, SACHEAD *hd)
 {
-    FILE    *strm;
+    SACFILE *strm;
     int     lswap;
 
-    if ((strm = fopen(name, "rb")) == NULL) {
+    if ((strm = sac_open(name)) == NULL) {
         fprintf(stderr, "Unable to open %s\n", name);
         return -1;
     }
 
     lswap = read_head_in(name, hd, strm);
 
-    fclose(strm);
+    sac_close(strm);
 
     return ((lswap == -1) ? -1 : 0);
 }
@@ -122,12 +180,12 @@ int read_sac_head(const char *name, SACHEAD *hd)
  */
 float *read_sac(const char *name, SACHEAD *hd)
 {
-    FILE    *strm;
+    SACFILE *strm;
     float   *ar;
     int     lswap;
     size_t  sz;
 
-    if ((strm = fopen(name, "rb")) == NULL) {
+    if ((strm = sac_open(name)) == NULL) {
         fprintf(stderr, "Unable to open %s\n", name);
         return NULL;
     }
@@ -135,7 +193,7 @@ float *read_sac(const char *name, SACHEAD *hd)
     lswap = read_head_in(name, hd, strm);
 
     if (lswap == -1) {
-        fclose(strm);
+        sac_close(strm);
         return NULL;
     }
 
@@ -144,17 +202,17 @@ float *read_sac(const char *name, SACHEAD *hd)
 
     if ((ar = (float *)malloc(sz)) == NULL) {
         fprintf(stderr, "Error in allocating memory for reading %s\n", name);
-        fclose(strm);
+        sac_close(strm);
         return NULL;
     }
 
-    if (fread((char*)ar, sz, 1, strm) != 1) {
+    if (sac_read(strm, ar, sz)) {
         fprintf(stderr, "Error in reading SAC data %s\n", name);
         free(ar);
-        fclose(strm);
+        sac_close(strm);
         return NULL;
     }
-    fclose(strm);
+    sac_close(strm);
 
     if (lswap == TRUE) byte_swap((char*)ar, sz);
 
@@ -242,6 +300,49 @@ int write_sac(const char *name, SACHEAD hd, const float *ar)
     return 0;
 }
 
+/*
+ *  write_sac_head
+ *
+ *  Description:    rewrite the header of an existing SAC file in place,
+ *                  keeping the byte order of the file. Data are untouched.
+ *
+ *  IN:
+ *      const char *name    :   file name
+ *      SACHEAD     hd      :   header
+ *
+ *  Return:
+ *      -1  :   fail
+ *      0   :   succeed
+ *
+ */
+int write_sac_head(const char *name, SACHEAD hd)
+{
+    FILE    *strm;
+    int     nvhdr, lswap;
+
+    if ((strm = fopen(name, "r+b")) == NULL) {
+        fprintf(stderr, "Error in opening file for writing %s\n", name);
+        return -1;
+    }
+
+    /* keep the byte order of the file */
+    if (fseek(strm, SAC_VERSION_LOCATION * SAC_DATA_SIZEOF, SEEK_SET) ||
+        fread(&nvhdr, sizeof(int), 1, strm) != 1 ||
+        (lswap = check_sac_nvhdr(nvhdr)) == -1) {
+        fprintf(stderr, "Warning: %s not in sac format.\n", name);
+        fclose(strm);
+        return -1;
+    }
+    if (lswap == TRUE) byte_swap((char *)&hd, SAC_HEADER_NUMBERS_SIZE);
+
+    if (fseek(strm, 0L, SEEK_SET) || write_head_out(name, hd, strm) == -1) {
+        fclose(strm);
+        return -1;
+    }
+    fclose(strm);
+    return 0;
+}
+
 /*
  *  write_sac_xy
  *
@@ -310,13 +411,13 @@ int write_sac_xy(const char *name, SACHEAD hd, const float *xdata, const float *
  */
 float *read_sac_pdw(const char *name, SACHEAD *hd, int tmark, float t1, float t2)
 {
-    FILE    *strm;
+    SACFILE *strm;
     int     lswap;
     float   tref;
     int     nt1, nt2, npts, nn;
     float   *ar, *fpt;
 
-    if ((strm = fopen(name, "rb")) == NULL) {
+    if ((strm = sac_open(name)) == NULL) {
         fprintf(stderr, "Error in opening %s\n", name);
         return NULL;
     }
@@ -324,14 +425,14 @@ float *read_sac_pdw(const char *name, SACHEAD *hd, int tmark, float t1, float t2
     lswap = read_head_in(name, hd, strm);
 
     if (lswap == -1) {
-        fclose(strm);
+        sac_close(strm);
         return NULL;
     }
 
     nn = (int)((t2-t1)/hd->delta);
     if (nn<=0 || (ar = (float *)calloc((size_t)nn, SAC_DATA_SIZEOF)) == NULL) {
         fprintf(stderr, "Errorin allocating memory for reading %s n=%d\n", name, nn);
-        fclose(strm);
+        sac_close(strm);
         return NULL;
     }
 
@@ -341,7 +442,7 @@ float *read_sac_pdw(const char *name, SACHEAD *hd, int tmark, float t1, float t2
         if (fabs(tref+12345.)<0.1) {
             fprintf(stderr, "Time mark undefined in %s\n", name);
             free(ar);
-            fclose(strm);
+            sac_close(strm);
             return NULL;
         }
     }
@@ -353,17 +454,21 @@ float *read_sac_pdw(const char *name, SACHEAD *hd, int tmark, float t1, float t2
     hd->b   = t1;
     hd->e   = t1 + nn * hd->delta;
 
-    if (nt1>npts || nt2 <0) return ar;    /* return zero filled array */
+    if (nt1>npts || nt2 <0) {     /* return zero filled array */
+        sac_close(strm);
+        return ar;
+    }
     /* maybe warnings are needed! */
 
     if (nt1<0) {
         fpt = ar - nt1;
         nt1 = 0;
     } else {
-        if (fseek(strm, nt1*SAC_DATA_SIZEOF, SEEK_CUR) < 0) {
+        sac_willneed(strm, (size_t)nt1*SAC_DATA_SIZEOF, (size_t)(((nt2 < npts) ? nt2 : npts) - nt1)*SAC_DATA_SIZEOF);
+        if (sac_skip(strm, (size_t)nt1*SAC_DATA_SIZEOF)) {
             fprintf(stderr, "Error in seek %s\n", name);
             free(ar);
-            fclose(strm);
+            sac_close(strm);
             return NULL;
         }
         fpt = ar;
@@ -371,19 +476,174 @@ float *read_sac_pdw(const char *name, SACHEAD *hd, int tmark, float t1, float t2
     if (nt2>npts) nt2 = npts;
     nn = nt2 - nt1;
 
-    if (fread((char *)fpt, (size_t)nn * SAC_DATA_SIZEOF, 1, strm) != 1) {
+    if (sac_read(strm, fpt, (size_t)nn * SAC_DATA_SIZEOF)) {
         fprintf(stderr, "Error in reading SAC data %s\n", name);
         free(ar);
-        fclose(strm);
+        sac_close(strm);
         return NULL;
     }
-    fclose(strm);
+    sac_close(strm);
 
-    if (lswap == TRUE) byte_swap((char*)ar, (size_t)nn*SAC_DATA_SIZEOF);
+    if (lswap == TRUE) byte_swap((char*)fpt, (size_t)nn*SAC_DATA_SIZEOF);
 
     return ar;
 }
 
+/*
+ *  read_sac_windows
+ *
+ *  Description:
+ *      Read several time windows of one SAC file with one open and one
+ *      header read. Windows are read in the order of their position in the
+ *      file, and windows that overlap or are at most SAC_WINDOW_GAP samples
+ *      apart are read together, so that the file is read forward only and
+ *      small gaps are read instead of skipped. Each window is zero padded
+ *      outside the data as in read_sac_pdw.
+ *
+ *  IN:
+ *      const char  *name   :   file name
+ *      int          n      :   number of windows
+ *      const float *t1     :   begin time of each window
+ *      const float *t2     :   end time of each window
+ *  OUT:
+ *      SACHEAD     *hd     :   SAC header of each window, with b, e and npts of the window
+ *      float      **ar     :   samples of each window, freed by the caller
+ *
+ *  Return: 0 if succeed, -1 if failed.
+ *
+ */
+int read_sac_windows(const char *name, int n, const float *t1, const float *t2, SACHEAD *hd, float **ar)
+{
+    SACFILE *strm;
+    SACHEAD head;
+    int     lswap, i, j, k, nn, cur = 0, s, e;
+    int     *order, *nt1, *c0, *c1, *next, *end;
+    float   *buf = NULL;
+
+    if ((strm = sac_open(name)) == NULL) {
+        fprintf(stderr, "Error in opening %s\n", name);
+        return -1;
+    }
+    if ((lswap = read_head_in(name, &head, strm)) == -1) {
+        sac_close(strm);
+        return -1;
+    }
+
+    order = (int *)malloc(6 * n * sizeof(int));
+    nt1 = order + n;  c0 = nt1 + n;  c1 = c0 + n;  next = c1 + n;  end = next + n;
+    for (k = 0; k < n; k++) ar[k] = NULL;
+    for (k = 0; k < n; k++) {
+        nn = (int)((t2[k]-t1[k])/head.delta);
+        if (nn <= 0 || (ar[k] = (float *)calloc((size_t)nn, SAC_DATA_SIZEOF)) == NULL) {
+            fprintf(stderr, "Errorin allocating memory for reading %s n=%d\n", name, nn);
+            goto fail;
+        }
+        hd[k] = head;
+        hd[k].npts = nn;
+        hd[k].b    = t1[k];
+        hd[k].e    = t1[k] + nn * head.delta;
+        nt1[k] = (int)((t1[k] - head.b) / head.delta);
+        c0[k] = (nt1[k] > 0) ? nt1[k] : 0;              /* samples of the file in the window */
+        c1[k] = (nt1[k] + nn < head.npts) ? nt1[k] + nn : head.npts;
+        /* insertion sort by the first sample */
+        for (j = k; j > 0 && c0[order[j-1]] > c0[k]; j--) order[j] = order[j-1];
+        order[j] = k;
+    }
+
+    for (i = 0; i < n; i = j) {
+        /* windows order[i..j-1] are read in one go, samples s to e-1 */
+        s = c0[order[i]];
+        e = c1[order[i]];
+        for (j = i + 1; j < n && c0[order[j]] <= e + SAC_WINDOW_GAP; j++)
+            if (c1[order[j]] > e) e = c1[order[j]];
+        next[i] = j;
+        end[i] = e;
+        /* let the kernel fetch all runs while the first ones are copied */
+        if (e > s) sac_willneed(strm, (size_t)s * SAC_DATA_SIZEOF, (size_t)(e - s) * SAC_DATA_SIZEOF);
+    }
+
+    for (i = 0; i < n; i = j) {
+        s = c0[order[i]];
+        e = end[i];
+        j = next[i];
+        if (e <= s) continue;       /* outside the data */
+        if ((buf = (float *)malloc((size_t)(e - s) * SAC_DATA_SIZEOF)) == NULL ||
+            sac_skip(strm, (size_t)(s - cur) * SAC_DATA_SIZEOF) ||
+            sac_read(strm, buf, (size_t)(e - s) * SAC_DATA_SIZEOF)) {
+            fprintf(stderr, "Error in reading SAC data %s\n", name);
+            goto fail;
+        }
+        cur = e;
+        if (lswap == TRUE) byte_swap((char *)buf, (size_t)(e - s) * SAC_DATA_SIZEOF);
+        for (k = i; k < j; k++)
+            if (c1[order[k]] > c0[order[k]])
+                memcpy(ar[order[k]] + (c0[order[k]] - nt1[order[k]]), buf + (c0[order[k]] - s),
+                       (size_t)(c1[order[k]] - c0[order[k]]) * SAC_DATA_SIZEOF);
+        free(buf);
+        buf = NULL;
+    }
+
+    free(order);
+    sac_close(strm);
+    return 0;
+
+fail:
+    for (k = 0; k < n; k++) free(ar[k]);
+    free(buf);
+    free(order);
+    sac_close(strm);
+    return -1;
+}
+
+/*
+ *  sac_advise
+ *
+ *  Description:
+ *      Tell the kernel that the data between t1 and t2 of a SAC file, or the
+ *      whole file if t2 <= t1, will be read soon, so that they are read in the
+ *      background. Compressed files are always hinted as a whole. Nothing is
+ *      done where posix_fadvise is not available.
+ *
+ *  IN:
+ *      const char  *name   :   file name
+ *      float        t1     :   begin time
+ *      float        t2     :   end time
+ *
+ *  Return: 0 if succeed, -1 if failed.
+ *
+ */
+int sac_advise(const char *name, float t1, float t2)
+{
+#ifdef POSIX_FADV_WILLNEED
+    SACFILE *strm;
+    SACHEAD hd;
+    int     i0, i1, fd;
+
+    if (t2 > t1) {      /* only the window of a plain file */
+        if ((strm = sac_open(name)) == NULL) return -1;
+        if (strm->type == SAC_PLAIN) {
+            if (read_head_in(name, &hd, strm) == -1) {
+                sac_close(strm);
+                return -1;
+            }
+            i0 = (int)((t1 - hd.b) / hd.delta);
+            i1 = i0 + (int)((t2 - t1) / hd.delta);
+            if (i0 < 0) i0 = 0;
+            if (i1 > hd.npts) i1 = hd.npts;
+            if (i1 > i0) sac_willneed(strm, (size_t)i0 * SAC_DATA_SIZEOF, (size_t)(i1 - i0) * SAC_DATA_SIZEOF);
+            sac_close(strm);
+            return 0;
+        }
+        sac_close(strm);
+    }
+    /* the whole file, without opening it as SAC or reading its header */
+    if ((fd = open(name, O_RDONLY)) < 0) return -1;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+#endif
+    return 0;
+}
+
 /*
  *  new_sac_head
  *
@@ -409,6 +669,121 @@ SACHEAD new_sac_head(float dt, int ns, float b0)
     return hd;
 }
 
+/*
+ *  read_sac_range
+ *
+ *  Description:
+ *      Read n samples starting at sample i0 of an evenly sampled SAC file.
+ *      Data before i0 are skipped by seeking, not read.
+ *
+ *  IN:
+ *      const char  *name   :   file name
+ *      int          i0     :   index of the first sample to read
+ *      int          n      :   number of samples to read, cut at the end of data
+ *  OUT:
+ *      SACHEAD     *hd     :   SAC header, with b, e and npts of the samples read
+ *
+ *  Return: float pointer to the data array, NULL if failed.
+ *
+ */
+float *read_sac_range(const char *name, SACHEAD *hd, int i0, int n)
+{
+    SACFILE *strm;
+    float   *ar;
+    int     lswap;
+    size_t  sz;
+
+    if ((strm = sac_open(name)) == NULL) {
+        fprintf(stderr, "Unable to open %s\n", name);
+        return NULL;
+    }
+
+    lswap = read_head_in(name, hd, strm);
+
+    if (lswap == -1) {
+        sac_close(strm);
+        return NULL;
+    }
+
+    if (hd->iftype == IXY || i0 < 0 || i0 >= hd->npts || n <= 0) {
+        fprintf(stderr, "Error in reading samples %d to %d of %s\n", i0, i0+n-1, name);
+        sac_close(strm);
+        return NULL;
+    }
+    if (n > hd->npts - i0) n = hd->npts - i0;
+
+    sz = (size_t) n * SAC_DATA_SIZEOF;
+    if ((ar = (float *)malloc(sz)) == NULL) {
+        fprintf(stderr, "Error in allocating memory for reading %s\n", name);
+        sac_close(strm);
+        return NULL;
+    }
+
+    if (sac_skip(strm, (size_t)i0 * SAC_DATA_SIZEOF) || sac_read(strm, ar, sz)) {
+        fprintf(stderr, "Error in reading SAC data %s\n", name);
+        free(ar);
+        sac_close(strm);
+        return NULL;
+    }
+    sac_close(strm);
+
+    if (lswap == TRUE) byte_swap((char*)ar, sz);
+
+    hd->b    += i0 * hd->delta;
+    hd->npts  = n;
+    hd->e     = hd->b + (n - 1) * hd->delta;
+
+    return ar;
+}
+
+/*
+ *  read_sac_stream
+ *
+ *  Description: Read the next SAC record from a stream of concatenated
+ *      binary SAC files, e.g. stdin or a pipe, without seeking. The byte
+ *      order is detected for each record.
+ *
+ *  IN:
+ *      FILE       *strm : stream opened for reading
+ *  OUT:
+ *      SACHEAD    *hd   : SAC header of the record
+ *  Return: float pointer to the data array, NULL at the end of the stream
+ *      or if failed.
+ *
+ */
+float *read_sac_stream(FILE *strm, SACHEAD *hd)
+{
+    SACFILE f;
+    float   *ar;
+    int     lswap, c;
+    size_t  sz;
+
+    if ((c = getc(strm)) == EOF) return NULL;   /* end of stream */
+    ungetc(c, strm);
+
+    memset(&f, 0, sizeof(SACFILE));     /* read as a plain file, without closing it */
+    f.strm = strm;
+    if ((lswap = read_head_in("stream", hd, &f)) == -1) return NULL;
+
+    sz = (size_t) hd->npts * SAC_DATA_SIZEOF;
+    if (hd->iftype == IXY) sz *= 2;
+
+    if ((ar = (float *)malloc(sz)) == NULL) {
+        fprintf(stderr, "Error in allocating memory for reading stream\n");
+        return NULL;
+    }
+
+    if (fread((char*)ar, sz, 1, strm) != 1) {
+        fprintf(stderr, "Error in reading SAC data from stream\n");
+        free(ar);
+        return NULL;
+    }
+
+    if (lswap == TRUE) byte_swap((char*)ar, sz);
+
+    return ar;
+}
+
 /*
  *  sac_head_index
  *
@@ -477,18 +852,500 @@ int sac_head_index(const char *name)
  */
 int issac(const char *name)
 {
-    FILE *strm;
-    int nvhdr;
+    SACFILE *strm;
+    int nvhdr, lswap;
+
+    if ((strm = sac_open(name)) == NULL) {
+        fprintf(stderr, "Unable to open %s\n", name);
+        return -1;
+    }
+
+    if (sac_skip(strm, SAC_VERSION_LOCATION * SAC_DATA_SIZEOF) ||
+        sac_read(strm, &nvhdr, sizeof(int)))
+        lswap = -1;
+    else
+        lswap = check_sac_nvhdr(nvhdr);
+    sac_close(strm);
+
+    return (lswap == -1) ? FALSE : TRUE;
+}
+
+/*
+ *  sac_epoch
+ *
+ *  Description: absolute time of the reference time of a SAC file
+ *               (nzyear, nzjday, nzhour, nzmin, nzsec and nzmsec).
+ *
+ *  In:
+ *      const SACHEAD *hd   :   SAC header
+ *  Out:
+ *      double  *t          :   seconds since 1970-01-01T00:00:00
+ *  Return:
+ *      -1 : fail, reference time undefined
+ *      0  : succeed
+ *
+ */
+int sac_epoch(const SACHEAD *hd, double *t)
+{
+    int y, days;
+
+    if (hd->nzyear == SAC_INT_UNDEF || hd->nzjday == SAC_INT_UNDEF ||
+        hd->nzhour == SAC_INT_UNDEF || hd->nzmin  == SAC_INT_UNDEF ||
+        hd->nzsec  == SAC_INT_UNDEF || hd->nzmsec == SAC_INT_UNDEF)
+        return -1;
+
+    /* days from 1970-01-01 to Jan 1st of nzyear, counting leap days */
+    y = hd->nzyear - 1;
+    days = 365 * (hd->nzyear - 1970) + (y/4 - y/100 + y/400) - (1969/4 - 1969/100 + 1969/400);
+    days += hd->nzjday - 1;
+
+    *t = days * 86400.0 + hd->nzhour * 3600.0 + hd->nzmin * 60.0 + hd->nzsec + hd->nzmsec * 0.001;
+    return 0;
+}
+
+/*
+ *  Min/max pyramid sidecar <name>.pyr of an evenly sampled SAC file.
+ *
+ *  Level k holds, for every block of SAC_PYR_BLOCK0*4^k samples, the minimum,
+ *  maximum, first and last sample of the block as 4 floats. Layout, in native
+ *  byte order:
+ *      char  magic[8]          "SACPYR2"
+ *      int   npts              npts of the SAC file
+ *      float delta, b          delta and b of the SAC file
+ *      long long mtime, size   modification time and size of the SAC file
+ *      int   nlevel
+ *      int   block[nlevel]     samples per block of each level
+ *      int   nblock[nlevel]    blocks of each level
+ *      float data[]            levels from the finest to the coarsest
+ */
+#define SAC_PYR_MAGIC   "SACPYR2"
+#define SAC_PYR_BLOCK0  16
+#define SAC_PYR_NLEVEL  16
+
+/*
+ *  write_sac_pyramid
+ *
+ *  Description: build the min/max pyramid sidecar <name>.pyr of a SAC file
+ *               in one pass over the data.
+ *
+ *  In:
+ *      const char *name    :   SAC file name
+ *  Return:
+ *      -1 : fail
+ *      0  : succeed
+ *
+ */
+int write_sac_pyramid(const char *name)
+{
+    SACHEAD hd;
+    FILE    *strm;
+    float   *ar, *lev[SAC_PYR_NLEVEL];
+    int     block[SAC_PYR_NLEVEL], nblock[SAC_PYR_NLEVEL];
+    int     nlevel = 0, i, k, j, n, m;
+    char    *pname;
+    int     error = 0;
+    struct stat st;
+    long long stamp[2];
+
+    if (stat(name, &st)) {
+        fprintf(stderr, "Error in opening %s\n", name);
+        return -1;
+    }
+    stamp[0] = (long long)st.st_mtime;
+    stamp[1] = (long long)st.st_size;
+    if ((ar = read_sac(name, &hd)) == NULL) return -1;
+    if (hd.iftype == IXY || hd.npts <= 0) {
+        fprintf(stderr, "Error in building pyramid of %s: not evenly sampled\n", name);
+        free(ar);
+        return -1;
+    }
+
+    /* finest level from samples, every further level from the previous one */
+    for (k = 0; k < SAC_PYR_NLEVEL; k++) {
+        n         = (k == 0) ? hd.npts : nblock[k-1];
+        m         = (k == 0) ? SAC_PYR_BLOCK0 : 4;     /* entries per block */
+        block[k]  = (k == 0) ? SAC_PYR_BLOCK0 : block[k-1] * 4;
+        nblock[k] = (n + m - 1) / m;
+        if ((lev[k] = (float *)malloc((size_t)nblock[k] * 4 * sizeof(float))) == NULL) {
+            fprintf(stderr, "Error in allocating memory for pyramid of %s\n", name);
+            error = -1;
+            break;
+        }
+        nlevel++;
+        for (i = 0; i < nblock[k]; i++) {
+            int i0 = i * m, i1 = (i0 + m < n) ? i0 + m : n;
+            float *p = &lev[k][4*i];
+            if (k == 0) {
+                p[0] = p[1] = p[2] = ar[i0];
+                for (j = i0 + 1; j < i1; j++) {
+                    if (ar[j] < p[0]) p[0] = ar[j];
+                    if (ar[j] > p[1]) p[1] = ar[j];
+                }
+                p[3] = ar[i1-1];
+            } else {
+                float *q = lev[k-1];
+                p[0] = q[4*i0];     p[1] = q[4*i0+1];
+                p[2] = q[4*i0+2];   p[3] = q[4*(i1-1)+3];
+                for (j = i0 + 1; j < i1; j++) {
+                    if (q[4*j]   < p[0]) p[0] = q[4*j];
+                    if (q[4*j+1] > p[1]) p[1] = q[4*j+1];
+                }
+            }
+        }
+        if (nblock[k] == 1) break;
+    }
+    free(ar);
+
+    if (!error) {
+        if ((pname = pyramid_name(name)) == NULL || (strm = fopen(pname, "wb")) == NULL) {
+            fprintf(stderr, "Error in opening pyramid of %s for writing\n", name);
+            error = -1;
+        } else {
+            char magic[8] = SAC_PYR_MAGIC;
+            if (fwrite(magic, 8, 1, strm) != 1 ||
+                fwrite(&hd.npts, sizeof(int), 1, strm) != 1 ||
+                fwrite(&hd.delta, sizeof(float), 1, strm) != 1 ||
+                fwrite(&hd.b, sizeof(float), 1, strm) != 1 ||
+                fwrite(stamp, sizeof(long long), 2, strm) != 2 ||
+                fwrite(&nlevel, sizeof(int), 1, strm) != 1 ||
+                fwrite(block, sizeof(int), nlevel, strm) != (size_t)nlevel ||
+                fwrite(nblock, sizeof(int), nlevel, strm) != (size_t)nlevel)
+                error = -1;
+            for (k = 0; k < nlevel && !error; k++)
+                if (fwrite(lev[k], sizeof(float) * 4, nblock[k], strm) != (size_t)nblock[k]) error = -1;
+            fclose(strm);
+            if (error) {
+                fprintf(stderr, "Error in writing pyramid %s\n", pname);
+                remove(pname);
+            }
+        }
+        free(pname);
+    }
+    for (k = 0; k < nlevel; k++) free(lev[k]);
+    return error;
+}
 
-    if ((strm = fopen(name, "rb")) == NULL) {
+/*
+ *  read_sac_pyramid
+ *
+ *  Description: read the coarsest level of the pyramid sidecar <name>.pyr
+ *               whose blocks have at most max_block samples.
+ *
+ *  In:
+ *      const char    *name      :   SAC file name
+ *      const SACHEAD *hd        :   SAC header, to reject stale sidecars
+ *                                   together with the mtime and size of the file
+ *      int            max_block :   maximum samples per block
+ *  Out:
+ *      int           *block     :   samples per block of the level read
+ *      int           *nblock    :   number of blocks
+ *  Return:
+ *      min, max, first and last sample of each block, 4*nblock floats.
+ *      NULL if there is no sidecar, it is stale, or no level is fine enough.
+ *
+ */
+float *read_sac_pyramid(const char *name, const SACHEAD *hd, int max_block, int *block, int *nblock)
+{
+    FILE    *strm;
+    char    magic[8], *pname;
+    int     npts, nlevel, k, lev = -1;
+    int     blk[SAC_PYR_NLEVEL], nblk[SAC_PYR_NLEVEL];
+    float   delta, b, *ar = NULL;
+    long    offset = 0;
+    struct stat st;
+    long long stamp[2];
+
+    if (stat(name, &st) || (pname = pyramid_name(name)) == NULL) return NULL;
+    strm = fopen(pname, "rb");
+    free(pname);
+    if (strm == NULL) return NULL;
+
+    if (fread(magic, 8, 1, strm) != 1 || strncmp(magic, SAC_PYR_MAGIC, 8) ||
+        fread(&npts, sizeof(int), 1, strm) != 1 ||
+        fread(&delta, sizeof(float), 1, strm) != 1 ||
+        fread(&b, sizeof(float), 1, strm) != 1 ||
+        fread(stamp, sizeof(long long), 2, strm) != 2 ||
+        fread(&nlevel, sizeof(int), 1, strm) != 1 ||
+        nlevel <= 0 || nlevel > SAC_PYR_NLEVEL ||
+        fread(blk, sizeof(int), nlevel, strm) != (size_t)nlevel ||
+        fread(nblk, sizeof(int), nlevel, strm) != (size_t)nlevel ||
+        npts != hd->npts || delta != hd->delta || b != hd->b ||
+        stamp[0] != (long long)st.st_mtime || stamp[1] != (long long)st.st_size) {
+        fclose(strm);
+        return NULL;
+    }
+
+    for (k = 0; k < nlevel && blk[k] <= max_block; k++) lev = k;
+    if (lev < 0) {
+        fclose(strm);
+        return NULL;
+    }
+    for (k = 0; k < lev; k++) offset += (long)nblk[k] * 4 * sizeof(float);
+
+    if ((ar = (float *)malloc((size_t)nblk[lev] * 4 * sizeof(float))) == NULL ||
+        fseek(strm, offset, SEEK_CUR) ||
+        fread(ar, sizeof(float) * 4, nblk[lev], strm) != (size_t)nblk[lev]) {
+        fprintf(stderr, "Error in reading pyramid of %s\n", name);
+        free(ar);
+        fclose(strm);
+        return NULL;
+    }
+    fclose(strm);
+
+    *block  = blk[lev];
+    *nblock = nblk[lev];
+    return ar;
+}
+
+/*
+ *  Bundle of SAC traces, to read a gather of many small SAC files with one
+ *  open. A table of all headers comes first, then the samples of each trace
+ *  at an offset aligned to SAC_BUNDLE_ALIGN bytes, so that a bundle in the
+ *  native byte order can be memory mapped. Layout:
+ *      char  magic[8]          "SACBND1"
+ *      int   n                 number of traces
+ *      int   nvhdr             SAC_HEADER_MAJOR_VERSION, gives the byte order
+ *      n entries of
+ *          char  member[SAC_BUNDLE_NAME]   name of the trace, 0 terminated
+ *          int   offset[2]                 low and high 32 bits of the byte
+ *                                          offset of its samples
+ *          SAC header as in a SAC file
+ *      samples of each trace
+ */
+#define SAC_BUNDLE_MAGIC    "SACBND1"
+#define SAC_BUNDLE_ALIGN    64
+#define SAC_BUNDLE_ENTRY    (SAC_BUNDLE_NAME + 2 * SAC_DATA_SIZEOF + SAC_HEADER_NUMBERS_SIZE + SAC_HEADER_STRINGS_SIZE)
+
+/*
+ *  write_sac_bundle
+ *
+ *  Description: write SAC traces into one bundle file
+ *
+ *  In:
+ *      const char   *name   :   bundle file name
+ *      int           n      :   number of traces
+ *      char *const  *member :   name of each trace, at most SAC_BUNDLE_NAME-1 characters
+ *      const SACHEAD *hd    :   header of each trace
+ *      float *const *data   :   samples of each trace
+ *  Return:
+ *      -1 : fail
+ *      0  : succeed
+ *
+ */
+int write_sac_bundle(const char *name, int n, char *const *member, const SACHEAD *hd, float *const *data)
+{
+    FILE    *strm;
+    char    magic[8] = SAC_BUNDLE_MAGIC, entry[SAC_BUNDLE_NAME], pad[SAC_BUNDLE_ALIGN];
+    int     i, nvhdr = SAC_HEADER_MAJOR_VERSION, offset[2];
+    long long pos, *start;
+    size_t  sz;
+
+    if ((start = (long long *)malloc((n + 1) * sizeof(long long))) == NULL) {
+        fprintf(stderr, "Error in allocating memory for bundle %s\n", name);
+        return -1;
+    }
+    pos = 8 + 2 * SAC_DATA_SIZEOF + (long long)n * SAC_BUNDLE_ENTRY;
+    for (i = 0; i < n; i++) {
+        sz = (size_t)hd[i].npts * SAC_DATA_SIZEOF;
+        if (hd[i].iftype == IXY) sz *= 2;
+        start[i] = (pos + SAC_BUNDLE_ALIGN - 1) / SAC_BUNDLE_ALIGN * SAC_BUNDLE_ALIGN;
+        pos = start[i] + sz;
+    }
+
+    if ((strm = fopen(name, "wb")) == NULL) {
+        fprintf(stderr, "Error in opening file for writing %s\n", name);
+        free(start);
+        return -1;
+    }
+    if (fwrite(magic, 8, 1, strm) != 1 || fwrite(&n, sizeof(int), 1, strm) != 1 ||
+        fwrite(&nvhdr, sizeof(int), 1, strm) != 1) goto fail;
+    for (i = 0; i < n; i++) {
+        memset(entry, 0, SAC_BUNDLE_NAME);
+        strncpy(entry, member[i], SAC_BUNDLE_NAME - 1);
+        offset[0] = (int)(start[i] & 0xffffffff);
+        offset[1] = (int)(start[i] >> 32);
+        if (fwrite(entry, SAC_BUNDLE_NAME, 1, strm) != 1 ||
+            fwrite(offset, sizeof(int), 2, strm) != 2 ||
+            write_head_out(name, hd[i], strm) == -1) goto fail;
+    }
+    memset(pad, 0, SAC_BUNDLE_ALIGN);
+    pos = 8 + 2 * SAC_DATA_SIZEOF + (long long)n * SAC_BUNDLE_ENTRY;
+    for (i = 0; i < n; i++) {
+        sz = (size_t)hd[i].npts * SAC_DATA_SIZEOF;
+        if (hd[i].iftype == IXY) sz *= 2;
+        if ((start[i] > pos && fwrite(pad, (size_t)(start[i] - pos), 1, strm) != 1) ||
+            (sz > 0 && fwrite(data[i], sz, 1, strm) != 1)) goto fail;
+        pos = start[i] + sz;
+    }
+    free(start);
+    fclose(strm);
+    return 0;
+
+fail:
+    fprintf(stderr, "Error in writing bundle %s\n", name);
+    free(start);
+    fclose(strm);
+    return -1;
+}
+
+/*
+ *  read_sac_bundle
+ *
+ *  Description: read the headers and samples of all traces in a bundle
+ *               with one open. The file is memory mapped if asked for and
+ *               in the native byte order, otherwise the samples are read
+ *               into one block with one sequential read.
+ *
+ *  In:
+ *      const char *name    :   bundle file name
+ *      int         map     :   TRUE to map the file instead of reading it
+ *  Out:
+ *      SACBUNDLE  *bd      :   traces of the bundle, to be freed by free_sac_bundle
+ *  Return:
+ *      -1 : fail
+ *      0  : succeed
+ *
+ */
+int read_sac_bundle(const char *name, SACBUNDLE *bd, int map)
+{
+    SACFILE f;
+    char    magic[8];
+    int     i, n, nvhdr, lswap, offset[2];
+    long long *start = NULL, first, end, table;
+    size_t  sz;
+    struct stat st;
+
+    memset(bd, 0, sizeof(SACBUNDLE));
+    memset(&f, 0, sizeof(SACFILE));
+    if ((f.strm = fopen(name, "rb")) == NULL) {
         fprintf(stderr, "Unable to open %s\n", name);
         return -1;
     }
+    if (fread(magic, 8, 1, f.strm) != 1 || strncmp(magic, SAC_BUNDLE_MAGIC, 8) ||
+        fread(&n, sizeof(int), 1, f.strm) != 1 || fread(&nvhdr, sizeof(int), 1, f.strm) != 1 ||
+        (lswap = check_sac_nvhdr(nvhdr)) == -1) {
+        fprintf(stderr, "Warning: %s not a SAC bundle.\n", name);
+        fclose(f.strm);
+        return -1;
+    }
+    if (lswap == TRUE) byte_swap((char *)&n, sizeof(int));
+    table = 8 + 2 * SAC_DATA_SIZEOF + (long long)n * SAC_BUNDLE_ENTRY;
+    if (fstat(fileno(f.strm), &st) || n < 0 || table > (long long)st.st_size) {
+        fprintf(stderr, "Error: table of bundle %s truncated\n", name);
+        fclose(f.strm);
+        return -1;
+    }
 
-    if (fseek(strm, SAC_VERSION_LOCATION * SAC_DATA_SIZEOF, SEEK_SET)) return FALSE;
-    if (fread(&nvhdr, sizeof(int), 1, strm) != 1) return FALSE;
-    if (check_sac_nvhdr(nvhdr) == -1) return FALSE;
-    else return TRUE;
+    bd->n      = n;
+    bd->member = (char **)calloc((size_t)n + 1, sizeof(char *));
+    bd->hd     = (SACHEAD *)calloc((size_t)n + 1, sizeof(SACHEAD));
+    bd->data   = (float **)calloc((size_t)n + 1, sizeof(float *));
+    start      = (long long *)calloc((size_t)n + 1, sizeof(long long));
+    if (n < 0 || !bd->member || !bd->hd || !bd->data || !start ||
+        (bd->member[0] = (char *)malloc((size_t)n * SAC_BUNDLE_NAME + 1)) == NULL) {
+        fprintf(stderr, "Error in allocating memory for bundle %s\n", name);
+        goto fail;
+    }
+
+    /* table of headers */
+    first = end = table;
+    for (i = 0; i < n; i++) {
+        bd->member[i] = bd->member[0] + (size_t)i * SAC_BUNDLE_NAME;
+        if (fread(bd->member[i], SAC_BUNDLE_NAME, 1, f.strm) != 1 ||
+            fread(offset, sizeof(int), 2, f.strm) != 2 ||
+            read_head_in(name, &bd->hd[i], &f) == -1) {
+            fprintf(stderr, "Error in reading table of bundle %s\n", name);
+            goto fail;
+        }
+        bd->member[i][SAC_BUNDLE_NAME-1] = '\0';
+        if (lswap == TRUE) byte_swap((char *)offset, 2 * sizeof(int));
+        start[i] = (long long)(unsigned int)offset[0] | (long long)offset[1] << 32;
+        sz = (size_t)bd->hd[i].npts * SAC_DATA_SIZEOF;
+        if (bd->hd[i].iftype == IXY) sz *= 2;
+        /* samples must lie after the table and inside the file, or mapping them faults */
+        if (bd->hd[i].npts < 0 || start[i] < table || start[i] + (long long)sz > (long long)st.st_size) {
+            fprintf(stderr, "Error: samples of %s beyond the end of bundle %s\n", bd->member[i], name);
+            goto fail;
+        }
+        if (i == 0 || start[i] < first) first = start[i];
+        if (start[i] + (long long)sz > end) end = start[i] + sz;
+    }
+
+    /* samples */
+    if (map && lswap == FALSE) {
+        bd->size = (size_t)end;
+        bd->base = mmap(NULL, bd->size, PROT_READ, MAP_SHARED, fileno(f.strm), 0);
+        if (bd->base == MAP_FAILED) bd->base = NULL;
+        else bd->mapped = TRUE;
+    }
+    if (!bd->mapped) {
+        bd->size = (size_t)(end - first);
+        if ((bd->base = malloc(bd->size + 1)) == NULL ||
+            fseek(f.strm, (long)first, SEEK_SET) ||
+            (bd->size > 0 && fread(bd->base, bd->size, 1, f.strm) != 1)) {
+            fprintf(stderr, "Error in reading samples of bundle %s\n", name);
+            goto fail;
+        }
+        if (lswap == TRUE) byte_swap((char *)bd->base, bd->size);
+    }
+    for (i = 0; i < n; i++)
+        bd->data[i] = (float *)((char *)bd->base + (start[i] - (bd->mapped ? 0 : first)));
+
+    free(start);
+    fclose(f.strm);
+    return 0;
+
+fail:
+    free(start);
+    fclose(f.strm);
+    free_sac_bundle(bd);
+    return -1;
+}
+
+/*
+ *  free_sac_bundle
+ *
+ *  Description: release the memory or mapping of a bundle read by read_sac_bundle
+ *
+ *  In:
+ *      SACBUNDLE *bd   :   bundle
+ *
+ */
+void free_sac_bundle(SACBUNDLE *bd)
+{
+    if (bd->base) {
+        if (bd->mapped) munmap(bd->base, bd->size);
+        else free(bd->base);
+    }
+    if (bd->member) free(bd->member[0]);
+    free(bd->member);
+    free(bd->hd);
+    free(bd->data);
+    memset(bd, 0, sizeof(SACBUNDLE));
+}
+
+/*
+ *  issacbundle
+ *
+ *  Description: check if a file is a bundle of SAC traces
+ *
+ *  In:
+ *      const char *name    :   file name
+ *  Return:
+ *      TRUE  : is a bundle
+ *      FALSE : not a bundle, or unable to read
+ *
+ */
+int issacbundle(const char *name)
+{
+    FILE *strm;
+    char magic[8];
+    int  ok;
+
+    if ((strm = fopen(name, "rb")) == NULL) return FALSE;
+    ok = (fread(magic, 8, 1, strm) == 1 && !strncmp(magic, SAC_BUNDLE_MAGIC, 8));
+    fclose(strm);
+    return ok ? TRUE : FALSE;
 }
 
 /******************************************************************************
@@ -591,14 +1448,14 @@ static void map_chdr_in(char *memar, char *buff)
  *  IN:
  *      const char *name : file name, only for debug
  *      SACHEAD    *hd   : header to be filled
- *      FILE       *strm : file handler
+ *      SACFILE    *strm : file handler
  *
  *  Return:
  *      0   :   Succeed and no byte swap
  *      1   :   Succeed and byte swap
  *     -1   :   fail.
  */
-static int read_head_in(const char *name, SACHEAD *hd, FILE *strm)
+static int read_head_in(const char *name, SACHEAD *hd, SACFILE *strm)
 {
     char   *buffer;
     int     lswap;
@@ -609,7 +1466,7 @@ static int read_head_in(const char *name, SACHEAD *hd, FILE *strm)
     }
 
     /* read numeric parts of the SAC header */
-    if (fread(hd, SAC_HEADER_NUMBERS_SIZE, 1, strm) != 1) {
+    if (sac_read(strm, hd, SAC_HEADER_NUMBERS_SIZE)) {
         fprintf(stderr, "Error in reading SAC header %s\n", name);
         return -1;
     }
@@ -628,7 +1485,7 @@ static int read_head_in(const char *name, SACHEAD *hd, FILE *strm)
         fprintf(stderr, "Error in allocating memory %s\n", name);
         return -1;
     }
-    if (fread(buffer, SAC_HEADER_STRINGS_SIZE, 1, strm) != 1) {
+    if (sac_read(strm, buffer, SAC_HEADER_STRINGS_SIZE)) {
         fprintf(stderr, "Error in reading SAC header %s\n", name);
         free(buffer);
         return -1;
@@ -707,3 +1564,236 @@ static int write_head_out(const char *name, SACHEAD hd, FILE *strm)
 
     return 0;
 }
+
+/*
+ *  pyramid_name : file name of the pyramid sidecar, <name>.pyr
+ *
+ *  Return: allocated string, NULL if failed
+ */
+static char *pyramid_name(const char *name)
+{
+    char *pname;
+
+    if ((pname = (char *)malloc(strlen(name) + 5)) == NULL) return NULL;
+    sprintf(pname, "%s.pyr", name);
+    return pname;
+}
+
+/*
+ *  sac_open:
+ *      open a SAC file for reading, plain or compressed by gzip or zstd
+ *      as told by its first bytes.
+ *
+ *  IN:
+ *      const char *name : file name
+ *
+ *  Return:
+ *      pointer to the opened file, NULL if failed.
+ */
+static SACFILE *sac_open(const char *name)
+{
+    SACFILE *f;
+    unsigned char magic[4] = {0, 0, 0, 0};
+
+    if ((f = (SACFILE *)calloc(1, sizeof(SACFILE))) == NULL) return NULL;
+    if ((f->strm = fopen(name, "rb")) == NULL) {
+        free(f);
+        return NULL;
+    }
+    if (fread(magic, 1, 4, f->strm) >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+        f->type = SAC_GZIP;
+    else if (magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd)
+        f->type = SAC_ZSTD;
+    rewind(f->strm);
+
+    switch (f->type) {
+        case SAC_GZIP:
+#ifdef HAVE_ZLIB
+            fclose(f->strm);
+            f->strm = NULL;
+            if ((f->gz = gzopen(name, "rb")) == NULL) {
+                free(f);
+                return NULL;
+            }
+            gzbuffer(f->gz, 128*1024);
+            return f;
+#else
+            fprintf(stderr, "Error: %s is compressed by gzip, not supported without zlib\n", name);
+            break;
+#endif
+        case SAC_ZSTD:
+#ifdef HAVE_ZSTD
+            if ((f->zd = ZSTD_createDCtx()) == NULL ||
+                (f->inbuf = (char *)malloc(ZSTD_DStreamInSize())) == NULL) break;
+            zstd_seek_table(f);
+            return f;
+#else
+            fprintf(stderr, "Error: %s is compressed by zstd, not supported without libzstd\n", name);
+            break;
+#endif
+        default:
+            return f;
+    }
+    sac_close(f);
+    return NULL;
+}
+
+/*
+ *  sac_read:
+ *      read exactly n bytes from a SAC file
+ *
+ *  Return:
+ *      0   :   succeed
+ *     -1   :   fail, or end of file reached
+ */
+static int sac_read(SACFILE *f, void *buf, size_t n)
+{
+#ifdef HAVE_ZLIB
+    if (f->type == SAC_GZIP) {
+        char *p = (char *)buf;
+        int got;
+        while (n > 0) {     /* gzread reads at most INT_MAX bytes at a time */
+            got = gzread(f->gz, p, (unsigned)(n > 0x40000000 ? 0x40000000 : n));
+            if (got <= 0) return -1;
+            p += got;
+            n -= (size_t)got;
+        }
+        return 0;
+    }
+#endif
+#ifdef HAVE_ZSTD
+    if (f->type == SAC_ZSTD) {
+        ZSTD_outBuffer out;
+        out.dst = buf;  out.size = n;  out.pos = 0;
+        while (out.pos < out.size) {
+            if (f->in.pos == f->in.size) {
+                f->in.src = f->inbuf;
+                f->in.size = fread(f->inbuf, 1, ZSTD_DStreamInSize(), f->strm);
+                f->in.pos = 0;
+                if (f->in.size == 0) return -1;
+            }
+            if (ZSTD_isError(ZSTD_decompressStream(f->zd, &out, &f->in))) return -1;
+        }
+        f->pos += n;
+        return 0;
+    }
+#endif
+    return (n == 0 || fread(buf, n, 1, f->strm) == 1) ? 0 : -1;
+}
+
+/*
+ *  sac_skip:
+ *      skip n bytes forward in a SAC file. Compressed data are decompressed
+ *      and thrown away, except that whole frames of a seekable zstd file
+ *      are jumped over with its seek table.
+ *
+ *  Return:
+ *      0   :   succeed
+ *     -1   :   fail
+ */
+static int sac_skip(SACFILE *f, size_t n)
+{
+    char    scratch[65536];
+    size_t  k;
+
+    if (f->type == SAC_PLAIN) return fseek(f->strm, (long)n, SEEK_CUR) ? -1 : 0;
+#ifdef HAVE_ZLIB
+    if (f->type == SAC_GZIP) return (gzseek(f->gz, (z_off_t)n, SEEK_CUR) < 0) ? -1 : 0;
+#endif
+#ifdef HAVE_ZSTD
+    if (f->type == SAC_ZSTD && f->nframe > 0) {
+        int i;
+        size_t target = f->pos + n;
+        for (i = 0; i < f->nframe - 1 && f->dpos[i+1] <= target; i++);
+        if (f->dpos[i] > f->pos) {  /* start decompressing at frame i */
+            if (fseek(f->strm, f->cpos[i], SEEK_SET)) return -1;
+            ZSTD_DCtx_reset(f->zd, ZSTD_reset_session_only);
+            f->in.pos = f->in.size = 0;
+            f->pos = f->dpos[i];
+        }
+        n = target - f->pos;
+    }
+#endif
+    while (n > 0) {
+        k = (n > sizeof(scratch)) ? sizeof(scratch) : n;
+        if (sac_read(f, scratch, k)) return -1;
+        n -= k;
+    }
+    return 0;
+}
+
+/*
+ *  sac_willneed:
+ *      tell the kernel that n bytes starting skip bytes after the current
+ *      position of a plain SAC file will be read soon, so that it starts
+ *      reading them in the background. Nothing is done for compressed
+ *      files, or where posix_fadvise is not available.
+ */
+static void sac_willneed(SACFILE *f, size_t skip, size_t n)
+{
+#ifdef POSIX_FADV_WILLNEED
+    long    pos;
+    if (f->type != SAC_PLAIN || n == 0 || (pos = ftell(f->strm)) < 0) return;
+    posix_fadvise(fileno(f->strm), (off_t)(pos + skip), (off_t)n, POSIX_FADV_WILLNEED);
+#endif
+}
+
+/*
+ *  sac_close:
+ *      close a SAC file opened by sac_open
+ */
+static void sac_close(SACFILE *f)
+{
+    if (f->strm) fclose(f->strm);
+#ifdef HAVE_ZLIB
+    if (f->gz) gzclose(f->gz);
+#endif
+#ifdef HAVE_ZSTD
+    if (f->zd) ZSTD_freeDCtx(f->zd);
+    free(f->inbuf);
+    free(f->cpos);
+    free(f->dpos);
+#endif
+    free(f);
+}
+
+#ifdef HAVE_ZSTD
+/*
+ *  zstd_seek_table:
+ *      read the seek table at the end of a file in the zstd seekable
+ *      format, if there is one, and rewind the file.
+ *      The table is a skippable frame of compressed and decompressed
+ *      sizes of all frames, closed by the number of frames, a descriptor
+ *      byte and the magic number 0x8F92EAB1, all little endian.
+ */
+static void zstd_seek_table(SACFILE *f)
+{
+    unsigned char footer[9], entry[12];
+    unsigned int nframe, magic, csize, dsize;
+    int i, esize;
+
+    f->nframe = 0;
+    if (fseek(f->strm, -9L, SEEK_END) || fread(footer, 9, 1, f->strm) != 1) goto done;
+    nframe = footer[0] | footer[1] << 8 | footer[2] << 16 | (unsigned)footer[3] << 24;
+    magic = footer[5] | footer[6] << 8 | footer[7] << 16 | (unsigned)footer[8] << 24;
+    if (magic != 0x8F92EAB1 || nframe == 0 || nframe > 0x1000000) goto done;
+    esize = (footer[4] & 0x80) ? 12 : 8;    /* entries carry checksums */
+    if (fseek(f->strm, -9L - (long)nframe * esize, SEEK_END)) goto done;
+
+    f->cpos = (long *)malloc((nframe + 1) * sizeof(long));
+    f->dpos = (size_t *)malloc((nframe + 1) * sizeof(size_t));
+    if (f->cpos == NULL || f->dpos == NULL) goto done;
+    f->cpos[0] = 0;
+    f->dpos[0] = 0;
+    for (i = 0; i < (int)nframe; i++) {
+        if (fread(entry, esize, 1, f->strm) != 1) goto done;
+        csize = entry[0] | entry[1] << 8 | entry[2] << 16 | (unsigned)entry[3] << 24;
+        dsize = entry[4] | entry[5] << 8 | entry[6] << 16 | (unsigned)entry[7] << 24;
+        f->cpos[i+1] = f->cpos[i] + csize;
+        f->dpos[i+1] = f->dpos[i] + dsize;
+    }
+    f->nframe = (int)nframe;
+done:
+    rewind(f->strm);
+}
+#endif
@@ -45,6 +45,8 @@
 #ifndef _SACIO_H
 #define _SACIO_H
 
+#include <stdio.h>
+
 /*******************************************************************************
                         SAC header structure
 
@@ -368,15 +370,41 @@ typedef struct sac_head {
 /* offset of USER0 relative to pointer to struct SACHEAD */
 #define USERN   40
 
+/* longest name of a trace in a SAC bundle, with the terminating 0 */
+#define SAC_BUNDLE_NAME 64
+
+/* all traces of a SAC bundle, filled by read_sac_bundle */
+typedef struct {
+    int       n;        /* number of traces */
+    char    **member;   /* name of each trace */
+    SACHEAD  *hd;       /* header of each trace */
+    float   **data;     /* samples of each trace, in base */
+    void     *base;     /* mapped file, or block of all samples */
+    size_t    size;     /* bytes in base */
+    int       mapped;   /* TRUE if base is a memory mapping */
+} SACBUNDLE;
+
 /* function prototype of basic SAC I/O */
 int read_sac_head(const char *name, SACHEAD *hd);
 float *read_sac(const char *name, SACHEAD *hd);
 int read_sac_xy(const char *name, SACHEAD *hd, float *xdata, float *ydata);
 float *read_sac_pdw(const char *name, SACHEAD *hd, int tmark, float t1, float t2);
+int read_sac_windows(const char *name, int n, const float *t1, const float *t2, SACHEAD *hd, float **ar);
+int sac_advise(const char *name, float t1, float t2);
+float *read_sac_range(const char *name, SACHEAD *hd, int i0, int n);
+float *read_sac_stream(FILE *strm, SACHEAD *hd);
 int write_sac(const char *name, SACHEAD hd, const float *ar);
+int write_sac_head(const char *name, SACHEAD hd);
 int write_sac_xy(const char *name, SACHEAD hd, const float *xdata, const float *ydata);
 SACHEAD new_sac_head(float dt, int ns, float b0);
 int sac_head_index(const char *name);
 int issac(const char *name);
+int sac_epoch(const SACHEAD *hd, double *t);
+int write_sac_pyramid(const char *name);
+float *read_sac_pyramid(const char *name, const SACHEAD *hd, int max_block, int *block, int *nblock);
+int write_sac_bundle(const char *name, int n, char *const *member, const SACHEAD *hd, float *const *data);
+int read_sac_bundle(const char *name, SACBUNDLE *bd, int map);
+void free_sac_bundle(SACBUNDLE *bd);
+int issacbundle(const char *name);
 
 #endif /* sacio.h */
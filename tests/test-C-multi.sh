@@ -0,0 +1,6 @@
+#!/bin/bash
+PS=test-C-multi.ps
+gmt pssac ntkl.z nykl.z onkl.z sdkl.z -JX15c/8c -R-20/580/-1/4 -Bx100 -By1 -BWSen -En -M1.5c -T+t1 \
+    -C-10/90 -C250/350+o-50 -C700/800+o-250 -K -P > $PS
+gmt psxy -J -R -O -T >> $PS
+rm gmt.*
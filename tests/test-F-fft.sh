@@ -0,0 +1,9 @@
+#!/bin/bash
+PS=test-F-fft.ps
+
+gmt pssac seis.sac -R9/20/-0.1/2 -JX15c/4c -B1 -W1p,black -Frh -K -P > $PS
+gmt pssac seis.sac -R9/20/-2/2 -JX15c/6c -B1 -W1p,black -Frdtf0.5/1/5/8 -Y6c -K -O >> $PS
+gmt pssac seis.sac -R9/20/-2/2 -JX15c/6c -B1 -W1p,black -Frdtw0.5 -M2c -Y7c -K -O >> $PS
+
+gmt psxy -R$R -J$J -O -T >> $PS
+rm gmt.*
@@ -0,0 +1,10 @@
+#!/bin/bash
+PS=test-F-filter.ps
+
+gmt pssac seis.sac -R9/20/-2/2 -JX15c/6c -B1 -W1p,black -Frdt -K -P > $PS
+gmt pssac seis.sac -R9/20/-2/2 -JX15c/6c -B1 -W1p,black -Frdtb1/5/4 -Y7c -K -O >> $PS
+gmt pssac seis.sac -R9/20/-2/2 -JX15c/6c -B1 -W1p,black -Frdtb1/5/4/2s2 -Y7c -K -O >> $PS
+gmt pssac seis.sac -R9/20/-0.1/2 -JX15c/4c -B1 -W1p,black -Frdtb1/5e0.5 -Y7c -K -O >> $PS
+
+gmt psxy -R$R -J$J -O -T >> $PS
+rm gmt.*
@@ -0,0 +1,8 @@
+#!/bin/bash
+PS=test-I.ps
+
+gmt pssac ntkl.z onkl.z nykl.z sdkl.z -JX15c/6c -R200/1600/10/45 -Bx200 -By5 -BWSen -Ed -M1.5c -I150 -K -P > $PS
+gmt pssac ntkl.z onkl.z nykl.z sdkl.z -JX15c/6c -R200/1600/10/45 -Bx200 -By5 -BWSen -Ed -M1.5c -Gp+gred -Gn+gblue -I -K -O -Y7c >> $PS
+
+gmt psxy -J$J -R$R -O -T >> $PS
+rm gmt.*
@@ -0,0 +1,8 @@
+#!/bin/bash
+PS=test-L.ps
+
+# 100-second rows of one trace, first row on top
+gmt pssac seis.sac -JX15c/-10c -R0/100/-1/10 -Bx20 -By1 -BWSen -M0.8c -L100 -K -P > $PS
+
+gmt psxy -J$J -R$R -O -T >> $PS
+rm gmt.*
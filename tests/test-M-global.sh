@@ -0,0 +1,16 @@
+#!/bin/bash
+R=195/1600/22/27
+J=X15c/4c
+Bx=x250
+By=y1
+PS=test-M-global.ps
+
+# -Msize/g|m|p<pct>
+gmt pssac ntkl.z onkl.z -J$J -R$R -B$Bx -B$By -BWSen -Ed -M1.5c/g -K -P > $PS
+gmt pssac ntkl.z onkl.z -J$J -R$R -B$Bx -B$By -BWsen -Ed -M1.5c/m -K -O -Y5c >> $PS
+gmt pssac ntkl.z onkl.z -J$J -R$R -B$Bx -B$By -BWsen -Ed -M1.5c/p50 -K -O -Y5c >> $PS
+gmt pssac ntkl.z onkl.z -J$J -R$R -B$Bx -B$By -BWsen -Ed -M1.5c/g -Fr -K -O -Y5c >> $PS
+gmt pssac ntkl.z onkl.z -J$J -R$R -B$Bx -B$By -BWsen -Ed -M1.5c/g -C500/1100 -K -O -Y5c >> $PS
+
+gmt psxy -J$J -R$R -O -T >> $PS
+rm gmt.*
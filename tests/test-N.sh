@@ -0,0 +1,10 @@
+#!/bin/bash
+PS=test-N.ps
+
+# bins of 25 degrees hold two of the four stations each
+gmt pssac ntkl.z onkl.z nykl.z sdkl.z -JX15c/6c -R-300/700/0/50 -Bx200 -By10 -BWSen -Ed -M1.5c -T+t1 -N25 -K -P > $PS
+gmt pssac ntkl.z onkl.z nykl.z sdkl.z -JX15c/6c -R-300/700/0/50 -Bx200 -By10 -BWSen -Ed -M1.5c -T+t1 -N25+n2 -K -O -Y7c >> $PS
+gmt pssac ntkl.z onkl.z nykl.z sdkl.z -JX15c/6c -R-300/700/0/50 -Bx200 -By10 -BWSen -Ed -M1.5c -T+t1 -N25+p2 -K -O -Y7c >> $PS
+
+gmt psxy -J -R -O -T >> $PS
+rm gmt.*
@@ -0,0 +1,13 @@
+#!/bin/bash
+R=195/1600/14/42
+J=X15c/6c
+PS=test-Q.ps
+
+cat ntkl.z onkl.z nykl.z sdkl.z | gmt pssac -J$J -R$R -Bx250 -By5 -BWSen -Ed -M0.8i -Q -K -P > $PS
+
+mkfifo sac.fifo
+cat ntkl.z onkl.z > sac.fifo &
+gmt pssac nykl.z sdkl.z -J$J -R$R -Ed -M0.8i -W1p,red -Qsac.fifo -K -O >> $PS
+
+gmt psxy -J$J -R$R -O -T >> $PS
+rm sac.fifo gmt.*
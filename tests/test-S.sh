@@ -0,0 +1,9 @@
+#!/bin/bash
+PS=test-S.ps
+
+# segments/ holds three pieces of ntkl.z: 2 and 1 overlap by 50 s, and 3 follows 2 after a 100 s gap
+gmt pssac segments/ntkl-3.z onkl.z segments/ntkl-1.z segments/ntkl-2.z sdkl.z -JX15c/5c -R200/1600/-1/3 -Bx200 -By1 -BWSen -En -M1c -S -K -P > $PS
+gmt pssac segments/ntkl-3.z onkl.z segments/ntkl-1.z segments/ntkl-2.z sdkl.z -JX15c/5c -R200/1600/-1/3 -Bx200 -By1 -BWSen -En -M1c -Fb0.01/0.1 -S -K -O -Y6c >> $PS
+
+gmt psxy -J -R -O -T >> $PS
+rm gmt.*
@@ -0,0 +1,8 @@
+#!/bin/bash
+PS=test-T-phase.ps
+
+gmt pssac ntkl.z onkl.z nykl.z sdkl.z -JX15c/6c -R-100/300/14/42 -Bx50 -By5 -BWSen -Ed -M1.5c -K -P -T+pP > $PS
+gmt pssac ntkl.z onkl.z nykl.z sdkl.z -JX15c/6c -R-100/300/14/42 -Bx50 -By5 -BWSen -Ed -M1.5c -K -O -Y7c -T+pS >> $PS
+
+gmt psxy -J$J -R$R -O -T >> $PS
+rm gmt.*
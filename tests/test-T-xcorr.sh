@@ -0,0 +1,9 @@
+#!/bin/bash
+PS=test-T-xcorr.ps
+
+gmt pssac ntkl.z onkl.z nykl.z sdkl.z -JX15c/6c -R-300/800/14/42 -Bx100 -By5 -BWSen -Ed -M1.5c -K -P -T+t1 > $PS
+gmt pssac ntkl.z onkl.z nykl.z sdkl.z -JX15c/6c -R-300/800/14/42 -Bx100 -By5 -BWSen -Ed -M1.5c -K -O -Y7c -T+t1+c-20/80 >> $PS
+gmt pssac ntkl.z onkl.z nykl.z sdkl.z -JX15c/6c -R-300/800/14/42 -Bx100 -By5 -BWSen -Ed -M1.5c -K -O -Y7c -T+t1+c-20/80/s3 -V >> $PS
+
+gmt psxy -J$J -R$R -O -T >> $PS
+rm gmt.*
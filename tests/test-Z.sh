@@ -0,0 +1,8 @@
+#!/bin/bash
+PS=test-Z.ps
+
+gmt pssac seis.sac -JX15c/5c -R9/20/-2/2 -Bx2 -By1 -BWSen -K -P > $PS
+gmt pssac seis.sac -J -R -Bx2 -By1 -BWSen -K -O -Y6c -Zb >> $PS
+
+gmt psxy -J$J -R$R -O -T >> $PS
+rm seis.sac.pyr gmt.*
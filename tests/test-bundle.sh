@@ -0,0 +1,13 @@
+#!/bin/bash
+R=195/1600/14/42
+J=X15c/6c
+PS=test-bundle.ps
+
+../sacbundle gather.sb ntkl.z nykl.z onkl.z sdkl.z
+gmt pssac gather.sb -J$J -R$R -Bx250 -By5 -BWSen -Ed -M0.8i -K -P > $PS
+gmt pssac -J$J -R$R -Bx250 -By5 -BWsen -Ed -M0.8i -K -O -Y7c >> $PS << EOF
+gather.sb#ntkl.z 195 16 2p,red
+gather.sb#sdkl.z 500 35 2.2p
+EOF
+gmt psxy -J$J -R$R -O -T >> $PS
+rm gather.sb gmt.*
@@ -0,0 +1,9 @@
+#!/bin/bash
+R=0/16/0/3
+J=X15c/6c
+PS=test-e.ps
+
+gmt pssac anmo.mseed st1.mseed -J$J -R$R -Bx2 -By1 -BWSen -En -M0.8i -K -P > $PS
+gmt pssac anmo.mseed st1.mseed -JM15c -R-120/30/0/45 -B30 -BWSen -estations.txt+e35/140 -M0.5i -K -O -Y8c >> $PS
+gmt psxy -J$J -R$R -O -T >> $PS
+rm gmt.*
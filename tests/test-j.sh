@@ -0,0 +1,18 @@
+#!/bin/bash
+R=195/1600/14/42
+J=X15c/6c
+PS=test-j.ps
+
+# the first job writes the plot of this test; the others share its traces and are only checked
+cat > jobs.txt << END
+$PS -J$J -R$R -Bx250 -By5 -BWSen -Ed -M0.8i -P ntkl.z onkl.z nykl.z sdkl.z
+test-j-2.tmp -J$J -R300/1200/14/42 -Bx100 -By5 -BWSen -Ed -M1.2i -C300/1200 -P ntkl.z onkl.z nykl.z sdkl.z
+test-j-3.tmp -J$J -R$R -Bx250 -By5 -BWSen -Ed -M0.8i -Fb0.02/0.2 -Gp+gred -P ntkl.z onkl.z nykl.z sdkl.z
+END
+gmt pssac -jjobs.txt+n2
+
+for f in test-j-2.tmp test-j-3.tmp; do
+    tail -1 $f | grep -q '%%EOF' || echo "$f: incomplete PostScript"
+done
+
+rm jobs.txt test-j-2.tmp test-j-3.tmp gmt.*
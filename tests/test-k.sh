@@ -0,0 +1,36 @@
+#!/bin/bash
+R=195/1600/14/42
+J=X15c/6c
+PS=test-k.ps
+SAC="ntkl.z nykl.z onkl.z sdkl.z"
+
+# plot twice with the same cache: the second run must take all 4 traces from the cache
+# and draw the same lines, within <tol> PostScript units
+check () {      # check <-k argument> <read|plotted> <tol> [options]
+    k=$1 how=$2 tol=$3
+    shift 3
+    gmt pssac $SAC -J$J -R$R -Bx250 -By5 -BWSen -Ed -M0.8i -P -k$k "$@" > first.ps
+    gmt pssac $SAC -J$J -R$R -Bx250 -By5 -BWSen -Ed -M0.8i -P -k$k "$@" -V 2> second.log > second.ps
+    n=$(grep -c ": $how from cache" second.log)
+    [ "$n" -eq 4 ] || echo "-k$k $*: $n of 4 traces $how from cache"
+    grep -v '^%%' first.ps | tr -s ' \t' '\n\n' > first.txt
+    grep -v '^%%' second.ps | tr -s ' \t' '\n\n' > second.txt
+    awk -v tol=$tol 'NR == FNR { a[FNR] = $1; next }
+        $1 != a[FNR] && !($1 + 0 == $1 && a[FNR] + 0 == a[FNR] && ($1 - a[FNR])^2 <= tol^2) { bad++ }
+        END { exit (bad > 0 || FNR != length (a)) }' first.txt second.txt ||
+        echo "-k$k $*: second plot differs from the first"
+    rm -r pssac.cache first.* second.*
+}
+
+check pssac.cache read 0 -Fb0.02/0.2
+check pssac.cache+p plotted 0
+check pssac.cache+q read 2
+
+# changing only the frame still draws all traces from the cache
+gmt pssac $SAC -J$J -R$R -Bx250 -By5 -BWSen -Ed -M0.8i -K -P -kpssac.cache+p > $PS
+gmt pssac $SAC -J$J -R$R -Bx200 -By10 -BWSen -Ed -M0.8i -K -O -Y7c -kpssac.cache+p -V 2> second.log >> $PS
+n=$(grep -c ": plotted from cache" second.log)
+[ "$n" -eq 4 ] || echo "-Bx200 -By10: $n of 4 traces plotted from cache"
+
+gmt psxy -J$J -R$R -O -T >> $PS
+rm -r pssac.cache second.log gmt.*
@@ -0,0 +1,19 @@
+#!/bin/bash
+PS=test-l.ps
+
+# live.sac grows from the first 600 to all 1000 samples of seis.sac between the runs,
+# so the second run resumes and plots only the new samples, in red
+rm -f live.state
+head -c 3032 seis.sac > live.sac
+printf '\130\002\000\000' | dd of=live.sac bs=1 seek=316 conv=notrunc 2> /dev/null     # npts=600
+gmt pssac live.sac -JX15c/5c -R9/20/-2/2 -Bx2 -By1 -BWSen -K -P -llive.state > $PS
+tail -c +3033 seis.sac >> live.sac
+printf '\350\003\000\000' | dd of=live.sac bs=1 seek=316 conv=notrunc 2> /dev/null     # npts=1000
+gmt pssac live.sac -J -R -Wred -K -O -llive.state >> $PS
+grep -q '^live.sac 1000 ' live.state || echo "live.sac: state does not record 1000 samples"
+
+# the third run finds no new samples and plots nothing
+gmt pssac live.sac -J -R -K -O -llive.state >> $PS
+
+gmt psxy -J -R -O -T >> $PS
+rm live.sac live.state gmt.*
@@ -0,0 +1,17 @@
+#!/bin/bash
+R=195/1600/14/42
+J=X15c/6c
+PS=test-y.ps
+SOCK=/tmp/pssac-test.sock
+
+gmt pssac -y$SOCK &
+sleep 1
+
+# the second job reads the traces kept in memory by the server
+echo "-J$J -R$R -Bx250 -By5 -BWSen -Ed -M0.8i -K -P ntkl.z onkl.z nykl.z sdkl.z" | socat - UNIX-CONNECT:$SOCK > $PS
+printf -- "-J$J -R$R -Ed -M0.8i -C300/1200 -W1p,red -K -O\nntkl.z\nonkl.z\nnykl.z\nsdkl.z\n" | socat - UNIX-CONNECT:$SOCK >> $PS
+echo quit | socat - UNIX-CONNECT:$SOCK
+wait
+
+gmt psxy -J$J -R$R -O -T >> $PS
+rm gmt.*
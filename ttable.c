@@ -0,0 +1,430 @@
+/*******************************************************************************
+ *                                  ttable.c                                   *
+ *  Travel time tables of first arriving P and S waves:                        *
+ *      ttable_lookup    travel time for a given distance and source depth     *
+ *                                                                             *
+ *  Tables are computed for the IASP91 model (Kennett & Engdahl, 1991) by      *
+ *  exact ray integration through 1 km thick constant velocity shells, for     *
+ *  epicentral distances 0-100 degree at a 1 degree interval and the source    *
+ *  depths in tt_depth. Beyond the core shadow the P and S times follow the    *
+ *  slowness of the ray grazing the core-mantle boundary. Times are in         *
+ *  seconds after the origin time, accurate to a few seconds, which is         *
+ *  sufficient for aligning traces on a plot.                                  *
+ *                                                                             *
+ ******************************************************************************/
+
+#include "ttable.h"
+
+#define TT_NDEPTH   15
+#define TT_NDIST    101     /* 0-100 degree */
+#define TT_DDIST    1.0
+
+static const float tt_depth[TT_NDEPTH] = {
+    0.0, 10.0, 20.0, 35.0, 50.0, 75.0, 100.0, 150.0,
+    200.0, 250.0, 300.0, 400.0, 500.0, 600.0, 700.0
+};
+
+static const float tt_P[TT_NDEPTH][TT_NDIST] = {
+    /* 0 km */
+    {   0.0,   19.2,   35.0,   48.8,   62.5,   76.3,   90.0,  103.7,  117.5,  131.2,
+      144.9,  158.6,  172.3,  185.9,  199.6,  213.2,  226.4,  239.1,  251.6,  263.2,
+      274.1,  284.9,  295.7,  306.3,  316.3,  325.4,  334.5,  343.5,  352.5,  361.4,
+      370.3,  379.1,  387.9,  396.6,  405.3,  414.0,  422.6,  431.1,  439.5,  448.0,
+      456.3,  464.6,  472.8,  480.9,  489.0,  497.0,  504.9,  512.7,  520.5,  528.2,
+      535.9,  543.4,  550.9,  558.4,  565.7,  573.0,  580.2,  587.3,  594.4,  601.4,
+      608.3,  615.1,  621.9,  628.6,  635.2,  641.8,  648.2,  654.6,  661.0,  667.2,
+      673.4,  679.5,  685.6,  691.5,  697.4,  703.2,  709.0,  714.6,  720.2,  725.8,
+      731.2,  736.6,  741.9,  747.1,  752.2,  757.3,  762.2,  767.1,  771.9,  776.7,
+      781.3,  786.0,  790.6,  795.2,  799.8,  804.4,  808.9,  813.4,  817.9,  822.3,
+      826.7},
+    /* 10 km */
+    {   1.7,   19.2,   33.8,   47.6,   61.3,   75.1,   88.8,  102.5,  116.3,  130.0,
+      143.7,  157.4,  171.1,  184.7,  198.4,  212.0,  225.1,  237.8,  250.3,  261.7,
+      272.7,  283.5,  294.3,  304.9,  314.8,  323.9,  333.0,  342.0,  351.0,  359.9,
+      368.7,  377.6,  386.4,  395.1,  403.8,  412.4,  421.0,  429.5,  438.0,  446.4,
+      454.7,  463.0,  471.2,  479.3,  487.4,  495.4,  503.3,  511.2,  518.9,  526.7,
+      534.3,  541.9,  549.3,  556.8,  564.1,  571.4,  578.6,  585.7,  592.8,  599.8,
+      606.7,  613.5,  620.3,  627.0,  633.6,  640.1,  646.6,  653.0,  659.3,  665.6,
+      671.8,  677.9,  683.9,  689.9,  695.8,  701.6,  707.3,  713.0,  718.6,  724.1,
+      729.5,  734.9,  740.2,  745.4,  750.5,  755.6,  760.6,  765.5,  770.3,  775.0,
+      779.7,  784.3,  788.9,  793.5,  798.1,  802.7,  807.2,  811.7,  816.2,  820.6,
+      825.1},
+    /* 20 km */
+    {   3.4,   18.6,   32.6,   46.4,   60.1,   73.9,   87.6,  101.3,  115.1,  128.8,
+      142.5,  156.2,  169.9,  183.5,  197.2,  210.8,  223.8,  236.5,  248.9,  260.3,
+      271.3,  282.1,  292.8,  303.5,  313.3,  322.4,  331.5,  340.5,  349.4,  358.3,
+      367.2,  376.0,  384.8,  393.6,  402.3,  410.9,  419.5,  428.0,  436.5,  444.9,
+      453.2,  461.4,  469.6,  477.8,  485.8,  493.8,  501.7,  509.6,  517.4,  525.1,
+      532.7,  540.3,  547.8,  555.2,  562.5,  569.8,  577.0,  584.1,  591.2,  598.1,
+      605.1,  611.9,  618.7,  625.3,  632.0,  638.5,  645.0,  651.4,  657.7,  664.0,
+      670.1,  676.3,  682.3,  688.2,  694.1,  699.9,  705.7,  711.4,  716.9,  722.5,
+      727.9,  733.3,  738.5,  743.7,  748.9,  753.9,  758.9,  763.8,  768.6,  773.3,
+      778.0,  782.6,  787.2,  791.9,  796.4,  801.0,  805.5,  810.0,  814.5,  818.9,
+      823.4},
+    /* 35 km */
+    {   5.8,   17.5,   31.3,   45.0,   58.8,   72.5,   86.2,  100.0,  113.7,  127.4,
+      141.1,  154.8,  168.5,  182.1,  195.8,  209.3,  222.3,  235.0,  247.3,  258.6,
+      269.5,  280.3,  291.0,  301.6,  311.3,  320.4,  329.5,  338.5,  347.5,  356.4,
+      365.2,  374.1,  382.8,  391.6,  400.3,  408.9,  417.5,  426.0,  434.4,  442.8,
+      451.2,  459.4,  467.6,  475.7,  483.8,  491.8,  499.7,  507.5,  515.3,  523.0,
+      530.6,  538.2,  545.7,  553.1,  560.4,  567.7,  574.9,  582.0,  589.1,  596.0,
+      602.9,  609.8,  616.5,  623.2,  629.8,  636.4,  642.8,  649.2,  655.6,  661.8,
+      668.0,  674.1,  680.1,  686.1,  692.0,  697.8,  703.5,  709.2,  714.8,  720.3,
+      725.7,  731.1,  736.3,  741.5,  746.7,  751.7,  756.7,  761.6,  766.4,  771.1,
+      775.8,  780.4,  785.0,  789.6,  794.2,  798.8,  803.3,  807.8,  812.3,  816.7,
+      821.2},
+    /* 50 km */
+    {   7.6,   17.7,   31.3,   45.0,   58.7,   72.5,   86.2,   99.9,  113.6,  127.3,
+      141.0,  154.6,  168.3,  181.9,  195.6,  208.7,  221.6,  234.2,  246.5,  257.4,
+      268.3,  279.2,  289.9,  300.4,  309.9,  319.0,  328.1,  337.1,  346.1,  355.0,
+      363.8,  372.6,  381.4,  390.1,  398.8,  407.4,  416.0,  424.5,  433.0,  441.4,
+      449.7,  457.9,  466.1,  474.2,  482.3,  490.3,  498.2,  506.0,  513.8,  521.5,
+      529.1,  536.6,  544.1,  551.5,  558.9,  566.1,  573.3,  580.4,  587.5,  594.4,
+      601.3,  608.2,  614.9,  621.6,  628.2,  634.7,  641.2,  647.6,  653.9,  660.1,
+      666.3,  672.4,  678.4,  684.4,  690.3,  696.1,  701.8,  707.5,  713.1,  718.6,
+      724.0,  729.3,  734.6,  739.8,  744.9,  750.0,  754.9,  759.8,  764.6,  769.4,
+      774.0,  778.6,  783.3,  787.9,  792.5,  797.0,  801.5,  806.0,  810.5,  815.0,
+      819.4},
+    /* 75 km */
+    {  10.7,   18.7,   31.7,   45.2,   58.8,   72.5,   86.1,   99.8,  113.5,  127.1,
+      140.8,  154.4,  168.0,  181.6,  194.7,  207.7,  220.4,  232.8,  244.6,  255.6,
+      266.4,  277.2,  287.9,  298.5,  307.6,  316.7,  325.8,  334.8,  343.7,  352.6,
+      361.4,  370.2,  379.0,  387.7,  396.4,  405.0,  413.6,  422.1,  430.5,  438.9,
+      447.2,  455.4,  463.6,  471.7,  479.8,  487.7,  495.6,  503.5,  511.2,  518.9,
+      526.5,  534.0,  541.5,  548.9,  556.2,  563.5,  570.7,  577.8,  584.8,  591.8,
+      598.6,  605.5,  612.2,  618.9,  625.5,  632.0,  638.5,  644.8,  651.1,  657.4,
+      663.5,  669.6,  675.7,  681.6,  687.5,  693.3,  699.0,  704.6,  710.2,  715.7,
+      721.1,  726.5,  731.7,  736.9,  742.1,  747.1,  752.0,  756.9,  761.7,  766.4,
+      771.1,  775.7,  780.3,  784.9,  789.5,  794.1,  798.6,  803.1,  807.6,  812.0,
+      816.5},
+    /* 100 km */
+    {  13.8,   20.4,   32.5,   45.7,   59.1,   72.7,   86.2,   99.8,  113.4,  127.0,
+      140.6,  154.2,  167.6,  180.8,  193.8,  206.6,  219.2,  231.5,  242.8,  253.7,
+      264.6,  275.3,  286.0,  296.2,  305.3,  314.4,  323.4,  332.4,  341.4,  350.2,
+      359.1,  367.9,  376.6,  385.3,  394.0,  402.6,  411.2,  419.6,  428.1,  436.4,
+      444.7,  453.0,  461.1,  469.2,  477.2,  485.2,  493.1,  500.9,  508.6,  516.3,
+      523.9,  531.4,  538.9,  546.3,  553.6,  560.8,  568.0,  575.1,  582.1,  589.1,
+      596.0,  602.8,  609.5,  616.2,  622.7,  629.3,  635.7,  642.1,  648.4,  654.6,
+      660.8,  666.8,  672.9,  678.8,  684.7,  690.4,  696.2,  701.8,  707.4,  712.9,
+      718.3,  723.6,  728.9,  734.1,  739.2,  744.2,  749.2,  754.0,  758.8,  763.5,
+      768.2,  772.8,  777.4,  782.0,  786.6,  791.2,  795.7,  800.2,  804.6,  809.1,
+      813.5},
+    /* 150 km */
+    {  20.0,   24.7,   35.1,   47.3,   60.2,   73.4,   86.6,  100.0,  113.3,  126.6,
+      139.9,  153.1,  166.2,  179.1,  191.8,  204.3,  216.6,  228.2,  239.1,  250.0,
+      260.8,  271.5,  282.1,  291.6,  300.7,  309.8,  318.8,  327.8,  336.7,  345.5,
+      354.4,  363.2,  371.9,  380.6,  389.2,  397.8,  406.4,  414.8,  423.2,  431.6,
+      439.8,  448.0,  456.2,  464.3,  472.3,  480.2,  488.0,  495.8,  503.6,  511.2,
+      518.8,  526.3,  533.7,  541.1,  548.4,  555.6,  562.7,  569.8,  576.8,  583.8,
+      590.6,  597.4,  604.1,  610.8,  617.3,  623.8,  630.3,  636.6,  642.9,  649.1,
+      655.2,  661.3,  667.3,  673.2,  679.1,  684.8,  690.5,  696.2,  701.7,  707.2,
+      712.6,  717.9,  723.2,  728.3,  733.4,  738.4,  743.4,  748.2,  753.0,  757.7,
+      762.3,  767.0,  771.6,  776.2,  780.8,  785.3,  789.8,  794.3,  798.8,  803.2,
+      807.7},
+    /* 200 km */
+    {  26.1,   29.7,   38.5,   49.6,   61.7,   74.4,   87.2,  100.2,  113.2,  126.2,
+      139.2,  152.1,  164.8,  177.4,  189.8,  202.1,  213.8,  224.8,  235.7,  246.5,
+      257.3,  267.9,  278.1,  287.2,  296.3,  305.4,  314.4,  323.3,  332.2,  341.0,
+      349.8,  358.6,  367.3,  376.0,  384.6,  393.2,  401.7,  410.1,  418.5,  426.8,
+      435.1,  443.3,  451.4,  459.4,  467.4,  475.3,  483.1,  490.9,  498.6,  506.2,
+      513.8,  521.3,  528.7,  536.0,  543.3,  550.5,  557.6,  564.7,  571.6,  578.6,
+      585.4,  592.2,  598.9,  605.5,  612.0,  618.5,  624.9,  631.3,  637.5,  643.7,
+      649.8,  655.9,  661.9,  667.8,  673.6,  679.4,  685.0,  690.6,  696.2,  701.6,
+      707.0,  712.3,  717.6,  722.7,  727.8,  732.8,  737.7,  742.6,  747.3,  752.0,
+      756.6,  761.3,  765.9,  770.5,  775.1,  779.6,  784.1,  788.6,  793.1,  797.5,
+      801.9},
+    /* 250 km */
+    {  32.1,   35.0,   42.4,   52.4,   63.7,   75.7,   88.1,  100.6,  113.2,  125.9,
+      138.5,  151.1,  163.5,  175.9,  188.1,  199.7,  210.7,  221.7,  232.5,  243.3,
+      253.9,  264.4,  273.9,  283.0,  292.1,  301.1,  310.1,  319.0,  327.8,  336.7,
+      345.5,  354.2,  362.9,  371.6,  380.2,  388.7,  397.2,  405.6,  414.0,  422.2,
+      430.5,  438.6,  446.7,  454.7,  462.7,  470.6,  478.4,  486.1,  493.8,  501.4,
+      508.9,  516.4,  523.8,  531.1,  538.3,  545.5,  552.6,  559.6,  566.6,  573.5,
+      580.3,  587.1,  593.7,  600.3,  606.9,  613.3,  619.7,  626.0,  632.3,  638.5,
+      644.6,  650.6,  656.6,  662.4,  668.3,  674.0,  679.7,  685.3,  690.8,  696.2,
+      701.6,  706.9,  712.1,  717.2,  722.3,  727.3,  732.2,  737.0,  741.8,  746.4,
+      751.1,  755.7,  760.3,  764.9,  769.5,  774.0,  778.5,  783.0,  787.4,  791.9,
+      796.3},
+    /* 300 km */
+    {  38.0,   40.3,   46.7,   55.7,   66.2,   77.5,   89.3,  101.3,  113.5,  125.8,
+      138.1,  150.3,  162.5,  174.5,  186.0,  197.0,  207.9,  218.8,  229.6,  240.2,
+      250.8,  260.8,  269.9,  279.0,  288.0,  297.0,  306.0,  314.9,  323.7,  332.5,
+      341.3,  350.0,  358.7,  367.3,  375.9,  384.4,  392.9,  401.3,  409.6,  417.9,
+      426.0,  434.2,  442.2,  450.2,  458.2,  466.0,  473.8,  481.5,  489.2,  496.7,
+      504.2,  511.7,  519.0,  526.3,  533.6,  540.7,  547.8,  554.8,  561.7,  568.6,
+      575.4,  582.1,  588.8,  595.4,  601.9,  608.3,  614.7,  621.0,  627.2,  633.4,
+      639.4,  645.5,  651.4,  657.3,  663.1,  668.8,  674.4,  680.0,  685.5,  690.9,
+      696.3,  701.6,  706.8,  711.9,  716.9,  721.9,  726.8,  731.6,  736.3,  741.0,
+      745.6,  750.2,  754.9,  759.4,  764.0,  768.5,  773.0,  777.5,  782.0,  786.4,
+      790.8},
+    /* 400 km */
+    {  49.3,   51.0,   55.9,   63.2,   72.0,   82.0,   92.6,  103.6,  114.9,  126.4,
+      137.5,  148.6,  159.6,  170.6,  181.5,  192.4,  203.2,  213.8,  224.4,  234.9,
+      244.3,  253.5,  262.5,  271.6,  280.6,  289.5,  298.4,  307.3,  316.1,  324.8,
+      333.6,  342.3,  350.9,  359.4,  368.0,  376.4,  384.8,  393.1,  401.4,  409.6,
+      417.7,  425.8,  433.8,  441.8,  449.6,  457.4,  465.2,  472.8,  480.4,  487.9,
+      495.4,  502.8,  510.1,  517.3,  524.5,  531.6,  538.6,  545.6,  552.5,  559.3,
+      566.0,  572.7,  579.3,  585.9,  592.3,  598.7,  605.1,  611.3,  617.5,  623.6,
+      629.7,  635.6,  641.5,  647.4,  653.1,  658.8,  664.4,  669.9,  675.4,  680.8,
+      686.1,  691.4,  696.5,  701.6,  706.6,  711.6,  716.4,  721.2,  725.9,  730.5,
+      735.2,  739.8,  744.4,  749.0,  753.5,  758.0,  762.5,  767.0,  771.4,  775.9,
+      780.3},
+    /* 500 km */
+    {  59.9,   61.2,   65.0,   70.9,   78.3,   86.9,   96.2,  106.1,  116.3,  126.7,
+      137.3,  147.9,  158.5,  169.1,  179.6,  190.1,  200.5,  210.9,  220.3,  229.4,
+      238.5,  247.6,  256.6,  265.6,  274.5,  283.4,  292.2,  301.0,  309.8,  318.5,
+      327.1,  335.8,  344.3,  352.8,  361.3,  369.6,  378.0,  386.2,  394.4,  402.6,
+      410.6,  418.6,  426.6,  434.4,  442.2,  450.0,  457.6,  465.2,  472.7,  480.2,
+      487.6,  494.9,  502.2,  509.3,  516.5,  523.5,  530.5,  537.4,  544.2,  551.0,
+      557.7,  564.3,  570.9,  577.3,  583.8,  590.1,  596.4,  602.6,  608.7,  614.8,
+      620.8,  626.7,  632.6,  638.4,  644.1,  649.7,  655.3,  660.8,  666.2,  671.6,
+      676.8,  682.1,  687.2,  692.2,  697.2,  702.1,  706.9,  711.7,  716.3,  721.0,
+      725.6,  730.2,  734.8,  739.4,  743.9,  748.4,  752.9,  757.3,  761.8,  766.2,
+      770.6},
+    /* 600 km */
+    {  70.1,   71.1,   74.2,   79.1,   85.4,   92.8,  101.0,  109.9,  119.2,  128.8,
+      138.7,  148.6,  158.6,  168.7,  178.8,  188.1,  197.2,  206.4,  215.5,  224.6,
+      233.6,  242.6,  251.5,  260.4,  269.3,  278.1,  286.9,  295.6,  304.3,  312.9,
+      321.5,  330.0,  338.5,  346.9,  355.3,  363.6,  371.8,  380.0,  388.1,  396.2,
+      404.2,  412.1,  420.0,  427.7,  435.5,  443.1,  450.7,  458.2,  465.7,  473.1,
+      480.4,  487.7,  494.8,  502.0,  509.0,  516.0,  522.9,  529.7,  536.5,  543.2,
+      549.9,  556.4,  562.9,  569.4,  575.7,  582.0,  588.3,  594.4,  600.5,  606.5,
+      612.5,  618.4,  624.2,  629.9,  635.6,  641.2,  646.7,  652.2,  657.5,  662.8,
+      668.1,  673.2,  678.3,  683.3,  688.3,  693.1,  697.9,  702.6,  707.2,  711.9,
+      716.5,  721.1,  725.7,  730.2,  734.7,  739.2,  743.7,  748.1,  752.6,  757.0,
+      761.5},
+    /* 700 km */
+    {  79.7,   80.6,   83.1,   87.2,   92.5,   99.0,  106.2,  114.1,  122.5,  131.2,
+      140.1,  149.1,  158.2,  167.3,  176.3,  185.4,  194.4,  203.4,  212.4,  221.3,
+      230.2,  239.1,  247.9,  256.7,  265.5,  274.2,  282.9,  291.5,  300.1,  308.6,
+      317.1,  325.5,  333.9,  342.2,  350.5,  358.6,  366.8,  374.9,  382.9,  390.8,
+      398.7,  406.6,  414.3,  422.0,  429.7,  437.2,  444.7,  452.2,  459.5,  466.9,
+      474.1,  481.3,  488.4,  495.4,  502.4,  509.3,  516.2,  522.9,  529.6,  536.3,
+      542.9,  549.4,  555.8,  562.2,  568.5,  574.7,  580.9,  587.0,  593.0,  599.0,
+      604.9,  610.7,  616.5,  622.1,  627.8,  633.3,  638.8,  644.2,  649.5,  654.8,
+      660.0,  665.1,  670.1,  675.1,  680.0,  684.8,  689.5,  694.2,  698.8,  703.4,
+      708.0,  712.6,  717.2,  721.7,  726.2,  730.7,  735.2,  739.6,  744.0,  748.5,
+      752.9}
+};
+
+static const float tt_S[TT_NDEPTH][TT_NDIST] = {
+    /* 0 km */
+    {   0.0,   33.1,   61.7,   86.5,  111.2,  135.9,  160.6,  185.3,  209.9,  234.5,
+      259.1,  283.6,  308.1,  332.6,  357.0,  381.3,  405.6,  429.9,  454.1,  478.2,
+      500.8,  520.8,  540.5,  559.1,  575.4,  591.5,  607.3,  623.1,  638.8,  654.6,
+      670.3,  685.9,  701.5,  717.0,  732.5,  747.9,  763.3,  778.5,  793.7,  808.8,
+      823.8,  838.7,  853.5,  868.2,  882.9,  897.4,  911.8,  926.1,  940.4,  954.5,
+      968.5,  982.4,  996.2, 1009.9, 1023.5, 1037.0, 1050.4, 1063.6, 1076.8, 1089.8,
+     1102.7, 1115.5, 1128.2, 1140.8, 1153.3, 1165.7, 1177.9, 1190.0, 1202.0, 1213.9,
+     1225.7, 1237.4, 1248.9, 1260.4, 1271.7, 1282.9, 1294.0, 1304.9, 1315.7, 1326.4,
+     1337.0, 1347.5, 1357.8, 1368.0, 1378.1, 1388.0, 1397.9, 1407.5, 1417.1, 1426.5,
+     1435.8, 1444.9, 1453.9, 1462.7, 1471.4, 1480.1, 1488.8, 1497.3, 1505.8, 1514.2,
+     1522.5},
+    /* 10 km */
+    {   3.0,   33.2,   59.8,   84.5,  109.2,  133.9,  158.6,  183.3,  207.9,  232.5,
+      257.1,  281.6,  306.1,  330.6,  355.0,  379.3,  403.6,  427.8,  452.0,  476.2,
+      498.5,  518.4,  538.1,  556.5,  572.8,  588.9,  604.7,  620.5,  636.2,  652.0,
+      667.6,  683.3,  698.9,  714.4,  729.9,  745.3,  760.6,  775.9,  791.0,  806.1,
+      821.1,  836.0,  850.8,  865.6,  880.2,  894.7,  909.1,  923.5,  937.7,  951.8,
+      965.8,  979.7,  993.5, 1007.2, 1020.8, 1034.3, 1047.6, 1060.9, 1074.0, 1087.1,
+     1100.0, 1112.8, 1125.5, 1138.1, 1150.5, 1162.9, 1175.1, 1187.3, 1199.3, 1211.2,
+     1222.9, 1234.6, 1246.2, 1257.6, 1268.9, 1280.1, 1291.2, 1302.1, 1312.9, 1323.6,
+     1334.2, 1344.7, 1355.0, 1365.2, 1375.3, 1385.2, 1395.0, 1404.7, 1414.2, 1423.6,
+     1432.9, 1442.0, 1451.0, 1459.8, 1468.6, 1477.3, 1485.9, 1494.4, 1502.9, 1511.3,
+     1519.6},
+    /* 20 km */
+    {   6.0,   32.2,   57.8,   82.5,  107.2,  131.9,  156.6,  181.3,  205.9,  230.5,
+      255.1,  279.7,  304.1,  328.6,  353.0,  377.3,  401.6,  425.8,  450.0,  474.2,
+      496.1,  516.0,  535.7,  554.0,  570.2,  586.3,  602.1,  617.9,  633.6,  649.3,
+      665.0,  680.7,  696.3,  711.8,  727.2,  742.6,  758.0,  773.2,  788.4,  803.5,
+      818.5,  833.4,  848.2,  862.9,  877.5,  892.0,  906.5,  920.8,  935.0,  949.1,
+      963.1,  977.0,  990.8, 1004.5, 1018.1, 1031.5, 1044.9, 1058.2, 1071.3, 1084.3,
+     1097.2, 1110.0, 1122.7, 1135.3, 1147.8, 1160.1, 1172.4, 1184.5, 1196.5, 1208.4,
+     1220.2, 1231.8, 1243.4, 1254.8, 1266.1, 1277.3, 1288.3, 1299.3, 1310.1, 1320.8,
+     1331.4, 1341.8, 1352.2, 1362.4, 1372.4, 1382.4, 1392.2, 1401.8, 1411.4, 1420.8,
+     1430.0, 1439.2, 1448.1, 1457.0, 1465.7, 1474.4, 1483.0, 1491.6, 1500.0, 1508.4,
+     1516.7},
+    /* 35 km */
+    {  10.0,   30.9,   55.6,   80.3,  105.1,  129.8,  154.4,  179.1,  203.7,  228.3,
+      252.9,  277.4,  301.9,  326.3,  350.7,  375.0,  399.3,  423.5,  447.7,  471.8,
+      493.2,  513.1,  532.7,  550.6,  566.9,  582.9,  598.7,  614.5,  630.2,  645.9,
+      661.6,  677.3,  692.9,  708.4,  723.8,  739.2,  754.6,  769.8,  785.0,  800.0,
+      815.0,  829.9,  844.7,  859.4,  874.0,  888.6,  903.0,  917.3,  931.5,  945.6,
+      959.6,  973.5,  987.3, 1001.0, 1014.5, 1028.0, 1041.3, 1054.6, 1067.7, 1080.7,
+     1093.6, 1106.4, 1119.1, 1131.7, 1144.1, 1156.5, 1168.7, 1180.8, 1192.8, 1204.7,
+     1216.5, 1228.1, 1239.7, 1251.1, 1262.4, 1273.6, 1284.6, 1295.6, 1306.4, 1317.1,
+     1327.6, 1338.1, 1348.4, 1358.6, 1368.7, 1378.6, 1388.4, 1398.1, 1407.6, 1417.0,
+     1426.2, 1435.4, 1444.3, 1453.2, 1461.9, 1470.6, 1479.2, 1487.7, 1496.2, 1504.6,
+     1512.9},
+    /* 50 km */
+    {  13.3,   31.2,   55.7,   80.3,  105.0,  129.6,  154.2,  178.8,  203.4,  228.0,
+      252.5,  277.0,  301.4,  325.8,  350.1,  374.4,  398.6,  422.8,  447.0,  471.1,
+      491.2,  511.0,  530.6,  548.1,  564.3,  580.3,  596.1,  611.9,  627.6,  643.4,
+      659.0,  674.7,  690.2,  705.8,  721.2,  736.6,  751.9,  767.1,  782.3,  797.4,
+      812.3,  827.2,  842.0,  856.7,  871.3,  885.8,  900.2,  914.5,  928.7,  942.8,
+      956.8,  970.7,  984.5,  998.2, 1011.7, 1025.2, 1038.5, 1051.7, 1064.9, 1077.9,
+     1090.8, 1103.6, 1116.2, 1128.8, 1141.2, 1153.6, 1165.8, 1177.9, 1189.9, 1201.8,
+     1213.5, 1225.2, 1236.7, 1248.1, 1259.4, 1270.6, 1281.6, 1292.6, 1303.4, 1314.1,
+     1324.6, 1335.0, 1345.4, 1355.5, 1365.6, 1375.5, 1385.3, 1395.0, 1404.5, 1413.9,
+     1423.1, 1432.2, 1441.2, 1450.0, 1458.7, 1467.4, 1476.0, 1484.6, 1493.0, 1501.4,
+     1509.8},
+    /* 75 km */
+    {  18.9,   33.1,   56.4,   80.7,  105.1,  129.6,  154.1,  178.6,  203.1,  227.5,
+      251.9,  276.3,  300.7,  325.0,  349.3,  373.5,  397.7,  421.8,  445.9,  467.9,
+      487.9,  507.7,  527.2,  543.9,  560.1,  576.1,  591.9,  607.6,  623.4,  639.1,
+      654.7,  670.4,  685.9,  701.4,  716.9,  732.2,  747.5,  762.8,  777.9,  792.9,
+      807.9,  822.8,  837.6,  852.2,  866.8,  881.3,  895.7,  910.0,  924.2,  938.3,
+      952.2,  966.1,  979.9,  993.5, 1007.1, 1020.5, 1033.8, 1047.0, 1060.1, 1073.1,
+     1086.0, 1098.8, 1111.4, 1124.0, 1136.4, 1148.7, 1161.0, 1173.0, 1185.0, 1196.9,
+     1208.6, 1220.3, 1231.8, 1243.2, 1254.4, 1265.6, 1276.6, 1287.6, 1298.3, 1309.0,
+     1319.6, 1330.0, 1340.3, 1350.5, 1360.5, 1370.4, 1380.2, 1389.8, 1399.3, 1408.7,
+     1418.0, 1427.0, 1436.0, 1444.8, 1453.5, 1462.2, 1470.8, 1479.3, 1487.8, 1496.2,
+     1504.5},
+    /* 100 km */
+    {  24.5,   36.1,   57.9,   81.5,  105.6,  129.8,  154.1,  178.5,  202.9,  227.2,
+      251.5,  275.8,  300.1,  324.3,  348.5,  372.7,  396.8,  420.9,  444.6,  464.8,
+      484.7,  504.4,  523.5,  539.8,  555.9,  571.8,  587.6,  603.4,  619.1,  634.8,
+      650.5,  666.1,  681.6,  697.1,  712.5,  727.9,  743.2,  758.4,  773.5,  788.6,
+      803.5,  818.4,  833.1,  847.8,  862.4,  876.8,  891.2,  905.5,  919.6,  933.7,
+      947.6,  961.5,  975.2,  988.9, 1002.4, 1015.8, 1029.1, 1042.3, 1055.4, 1068.4,
+     1081.3, 1094.0, 1106.7, 1119.2, 1131.6, 1143.9, 1156.1, 1168.2, 1180.2, 1192.0,
+     1203.7, 1215.4, 1226.9, 1238.2, 1249.5, 1260.6, 1271.7, 1282.6, 1293.3, 1304.0,
+     1314.5, 1324.9, 1335.2, 1345.4, 1355.4, 1365.3, 1375.1, 1384.7, 1394.2, 1403.6,
+     1412.8, 1421.9, 1430.8, 1439.6, 1448.3, 1457.0, 1465.6, 1474.1, 1482.6, 1490.9,
+     1499.3},
+    /* 150 km */
+    {  35.6,   44.0,   62.5,   84.4,  107.5,  131.1,  155.0,  178.9,  203.0,  227.1,
+      251.2,  275.3,  299.3,  323.4,  347.4,  371.4,  395.3,  418.1,  438.5,  458.5,
+      478.2,  497.7,  515.3,  531.5,  547.6,  563.4,  579.2,  594.9,  610.6,  626.3,
+      642.0,  657.6,  673.1,  688.6,  704.0,  719.3,  734.6,  749.7,  764.8,  779.8,
+      794.7,  809.6,  824.3,  838.9,  853.5,  867.9,  882.2,  896.5,  910.6,  924.6,
+      938.5,  952.4,  966.1,  979.7,  993.2, 1006.6, 1019.8, 1033.0, 1046.1, 1059.0,
+     1071.8, 1084.6, 1097.2, 1109.7, 1122.1, 1134.3, 1146.5, 1158.5, 1170.5, 1182.3,
+     1194.0, 1205.6, 1217.1, 1228.4, 1239.6, 1250.8, 1261.8, 1272.6, 1283.4, 1294.0,
+     1304.5, 1314.9, 1325.2, 1335.3, 1345.3, 1355.2, 1364.9, 1374.5, 1384.0, 1393.3,
+     1402.5, 1411.6, 1420.5, 1429.2, 1437.9, 1446.6, 1455.2, 1463.7, 1472.2, 1480.5,
+     1488.8},
+    /* 200 km */
+    {  46.7,   53.1,   68.8,   88.8,  110.7,  133.5,  156.7,  180.2,  203.8,  227.6,
+      251.4,  275.2,  299.1,  322.9,  346.2,  369.1,  391.8,  412.3,  432.4,  452.2,
+      471.8,  490.8,  507.1,  523.3,  539.3,  555.0,  570.8,  586.6,  602.3,  617.9,
+      633.6,  649.1,  664.6,  680.1,  695.5,  710.8,  726.0,  741.1,  756.2,  771.2,
+      786.0,  800.8,  815.5,  830.1,  844.6,  859.0,  873.3,  887.5,  901.6,  915.6,
+      929.5,  943.3,  957.0,  970.5,  984.0,  997.3, 1010.6, 1023.7, 1036.7, 1049.7,
+     1062.5, 1075.2, 1087.7, 1100.2, 1112.6, 1124.8, 1136.9, 1148.9, 1160.8, 1172.6,
+     1184.3, 1195.9, 1207.3, 1218.6, 1229.8, 1240.9, 1251.9, 1262.7, 1273.5, 1284.1,
+     1294.5, 1304.9, 1315.1, 1325.2, 1335.2, 1345.0, 1354.7, 1364.3, 1373.8, 1383.1,
+     1392.2, 1401.3, 1410.2, 1418.9, 1427.6, 1436.3, 1444.8, 1453.4, 1461.8, 1470.1,
+     1478.4},
+    /* 250 km */
+    {  57.6,   62.8,   76.2,   94.3,  114.8,  136.6,  159.0,  181.9,  204.9,  228.2,
+      251.4,  274.7,  297.8,  320.7,  343.5,  366.0,  386.5,  406.6,  426.5,  446.1,
+      465.6,  482.9,  499.2,  515.2,  531.1,  546.9,  562.6,  578.4,  594.1,  609.7,
+      625.3,  640.9,  656.3,  671.8,  687.1,  702.4,  717.6,  732.7,  747.7,  762.6,
+      777.5,  792.2,  806.9,  821.5,  835.9,  850.3,  864.6,  878.7,  892.8,  906.7,
+      920.6,  934.3,  948.0,  961.5,  974.9,  988.3, 1001.5, 1014.6, 1027.6, 1040.4,
+     1053.2, 1065.9, 1078.4, 1090.8, 1103.2, 1115.4, 1127.5, 1139.5, 1151.3, 1163.1,
+     1174.7, 1186.3, 1197.7, 1209.0, 1220.1, 1231.2, 1242.1, 1253.0, 1263.6, 1274.2,
+     1284.7, 1295.0, 1305.2, 1315.3, 1325.2, 1335.0, 1344.7, 1354.3, 1363.7, 1373.0,
+     1382.1, 1391.1, 1400.0, 1408.7, 1417.4, 1426.0, 1434.6, 1443.1, 1451.5, 1459.8,
+     1468.2},
+    /* 300 km */
+    {  68.4,   72.7,   84.3,  100.6,  119.6,  140.2,  161.6,  183.7,  206.1,  228.6,
+      251.3,  273.9,  296.5,  318.9,  340.9,  361.1,  381.3,  401.2,  420.9,  440.4,
+      458.9,  475.3,  491.5,  507.5,  523.3,  539.0,  554.8,  570.5,  586.2,  601.8,
+      617.4,  632.9,  648.4,  663.7,  679.1,  694.3,  709.5,  724.5,  739.5,  754.4,
+      769.2,  783.9,  798.6,  813.1,  827.5,  841.9,  856.1,  870.2,  884.2,  898.1,
+      912.0,  925.7,  939.3,  952.8,  966.2,  979.4,  992.6, 1005.7, 1018.6, 1031.5,
+     1044.2, 1056.8, 1069.4, 1081.8, 1094.1, 1106.2, 1118.3, 1130.2, 1142.1, 1153.8,
+     1165.4, 1176.9, 1188.3, 1199.6, 1210.7, 1221.7, 1232.6, 1243.4, 1254.1, 1264.6,
+     1275.0, 1285.3, 1295.5, 1305.6, 1315.5, 1325.3, 1334.9, 1344.4, 1353.8, 1363.1,
+     1372.2, 1381.2, 1390.0, 1398.7, 1407.4, 1416.0, 1424.6, 1433.1, 1441.4, 1449.8,
+     1458.1},
+    /* 400 km */
+    {  89.4,   92.6,  101.4,  114.6,  130.8,  149.0,  168.4,  188.7,  209.5,  230.6,
+      251.4,  271.8,  292.1,  312.4,  332.5,  352.4,  372.1,  391.7,  410.9,  428.5,
+      444.9,  461.0,  477.0,  492.8,  508.6,  524.3,  540.1,  555.7,  571.4,  586.9,
+      602.5,  617.9,  633.3,  648.6,  663.9,  679.1,  694.1,  709.1,  724.1,  738.9,
+      753.6,  768.2,  782.8,  797.2,  811.6,  825.8,  840.0,  854.0,  868.0,  881.8,
+      895.5,  909.2,  922.7,  936.1,  949.4,  962.6,  975.7,  988.7, 1001.6, 1014.4,
+     1027.0, 1039.6, 1052.0, 1064.4, 1076.6, 1088.7, 1100.7, 1112.6, 1124.3, 1136.0,
+     1147.5, 1159.0, 1170.3, 1181.5, 1192.5, 1203.5, 1214.3, 1225.1, 1235.7, 1246.1,
+     1256.5, 1266.7, 1276.8, 1286.8, 1296.7, 1306.4, 1316.0, 1325.5, 1334.8, 1344.0,
+     1353.0, 1362.0, 1370.7, 1379.4, 1388.1, 1396.7, 1405.2, 1413.7, 1422.0, 1430.3,
+     1438.7},
+    /* 500 km */
+    { 108.9,  111.3,  118.3,  129.0,  142.6,  158.3,  175.4,  193.5,  212.3,  231.4,
+      250.8,  270.2,  289.7,  309.1,  328.5,  347.7,  366.7,  384.4,  400.8,  417.1,
+      433.3,  449.2,  465.0,  480.7,  496.5,  512.2,  527.8,  543.5,  559.0,  574.5,
+      590.0,  605.4,  620.7,  635.9,  651.1,  666.2,  681.2,  696.1,  710.9,  725.6,
+      740.2,  754.8,  769.2,  783.6,  797.8,  812.0,  826.0,  840.0,  853.8,  867.6,
+      881.2,  894.7,  908.2,  921.5,  934.7,  947.8,  960.9,  973.8,  986.5,  999.2,
+     1011.8, 1024.3, 1036.6, 1048.9, 1061.0, 1073.0, 1085.0, 1096.8, 1108.5, 1120.0,
+     1131.5, 1142.9, 1154.1, 1165.2, 1176.2, 1187.1, 1197.9, 1208.5, 1219.0, 1229.5,
+     1239.7, 1249.9, 1259.9, 1269.9, 1279.6, 1289.3, 1298.8, 1308.2, 1317.5, 1326.6,
+     1335.6, 1344.4, 1353.2, 1361.9, 1370.5, 1379.1, 1387.5, 1395.9, 1404.3, 1412.6,
+     1420.9},
+    /* 600 km */
+    { 127.5,  129.5,  135.1,  144.0,  155.5,  169.1,  184.2,  200.4,  217.5,  235.1,
+      253.1,  271.3,  289.7,  308.1,  325.7,  342.3,  358.7,  375.1,  391.3,  407.3,
+      423.1,  438.9,  454.6,  470.4,  486.1,  501.7,  517.3,  532.9,  548.3,  563.8,
+      579.1,  594.4,  609.6,  624.8,  639.8,  654.8,  669.7,  684.5,  699.2,  713.8,
+      728.3,  742.7,  757.1,  771.3,  785.4,  799.5,  813.4,  827.3,  841.0,  854.7,
+      868.2,  881.6,  894.9,  908.2,  921.3,  934.3,  947.2,  960.0,  972.7,  985.3,
+      997.8, 1010.2, 1022.4, 1034.6, 1046.6, 1058.6, 1070.4, 1082.1, 1093.7, 1105.2,
+     1116.6, 1127.9, 1139.0, 1150.1, 1161.0, 1171.8, 1182.5, 1193.0, 1203.5, 1213.8,
+     1224.0, 1234.1, 1244.1, 1253.9, 1263.6, 1273.2, 1282.7, 1292.0, 1301.2, 1310.2,
+     1319.1, 1327.9, 1336.6, 1345.3, 1353.9, 1362.4, 1370.9, 1379.2, 1387.5, 1395.9,
+     1404.2},
+    /* 700 km */
+    { 145.0,  146.6,  151.3,  158.7,  168.5,  180.2,  193.5,  207.9,  223.1,  238.9,
+      255.1,  271.4,  287.7,  304.1,  320.3,  336.5,  352.5,  368.5,  384.3,  400.0,
+      415.8,  431.5,  447.2,  462.8,  478.4,  493.9,  509.4,  524.8,  540.2,  555.5,
+      570.7,  585.9,  600.9,  615.9,  630.8,  645.7,  660.4,  675.0,  689.6,  704.1,
+      718.5,  732.8,  747.0,  761.1,  775.1,  789.0,  802.8,  816.5,  830.1,  843.6,
+      857.0,  870.3,  883.5,  896.6,  909.6,  922.5,  935.3,  948.0,  960.6,  973.1,
+      985.5,  997.7, 1009.9, 1021.9, 1033.9, 1045.7, 1057.4, 1069.1, 1080.6, 1092.0,
+     1103.2, 1114.4, 1125.5, 1136.4, 1147.3, 1158.0, 1168.6, 1179.0, 1189.4, 1199.6,
+     1209.8, 1219.8, 1229.6, 1239.4, 1249.0, 1258.5, 1267.9, 1277.1, 1286.2, 1295.2,
+     1304.0, 1312.7, 1321.4, 1330.1, 1338.6, 1347.1, 1355.5, 1363.8, 1372.2, 1380.5,
+     1388.8}
+};
+/*
+ *  ttable_lookup
+ *
+ *  Description: travel time of the first arriving P or S wave, bilinearly
+ *      interpolated in distance and source depth.
+ *
+ *  IN:
+ *      char    phase   :   'P' or 'S'
+ *      double  gcarc   :   epicentral distance in degree
+ *      double  evdp    :   source depth in km, clipped to the table range
+ *
+ *  Return: travel time in seconds, or -1 if phase or gcarc is out of range
+ *
+ */
+double ttable_lookup(char phase, double gcarc, double evdp)
+{
+    const float (*tt)[TT_NDIST];
+    int     i, j;
+    double  u, v;
+
+    if (phase == 'P' || phase == 'p') tt = tt_P;
+    else if (phase == 'S' || phase == 's') tt = tt_S;
+    else return -1.0;
+
+    if (gcarc < 0.0 || gcarc > (TT_NDIST - 1) * TT_DDIST) return -1.0;
+
+    if (evdp < tt_depth[0]) evdp = tt_depth[0];
+    if (evdp > tt_depth[TT_NDEPTH-1]) evdp = tt_depth[TT_NDEPTH-1];
+
+    i = (int)(gcarc / TT_DDIST);
+    if (i > TT_NDIST - 2) i = TT_NDIST - 2;
+    u = gcarc / TT_DDIST - i;
+
+    for (j = 0; j < TT_NDEPTH - 2 && evdp > tt_depth[j+1]; j++);
+    v = (evdp - tt_depth[j]) / (tt_depth[j+1] - tt_depth[j]);
+
+    return (1.0 - v) * ((1.0 - u) * tt[j][i]   + u * tt[j][i+1])
+         +        v  * ((1.0 - u) * tt[j+1][i] + u * tt[j+1][i+1]);
+}
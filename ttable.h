@@ -0,0 +1,14 @@
+/*******************************************************************************
+    Name:     ttable.h
+
+    Purpose:  prototype for the built-in travel time tables of first
+        arriving P and S waves in the IASP91 model
+
+*******************************************************************************/
+
+#ifndef _TTABLE_H
+#define _TTABLE_H
+
+double ttable_lookup(char phase, double gcarc, double evdp);
+
+#endif /* ttable.h */